@@ -0,0 +1,134 @@
+/*
+ * Input-side benchmark: planar (deinterleave, import stride 1) against
+ * interleaved (import stride N) for each input io mode.
+ *
+ * Usage: import_bench <graph.awb> <input.pcm> [channels] [passes]
+ */
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include"AWECoreOS.h"
+#include"ModuleList.h"
+#include"pcm_source.h"
+#include"interleave.h"
+
+#define BENCH_BLOCK_SIZE 768
+#define BENCH_MAX_CHANNELS 16
+
+static const void* moduleDescriptorTable[] = {
+    LISTOFCLASSOBJECTS
+};
+
+static AWEOSInstance *awe;
+static INT32 temp[BENCH_BLOCK_SIZE * BENCH_MAX_CHANNELS];
+static INT32 planar[BENCH_BLOCK_SIZE * BENCH_MAX_CHANNELS];
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void run(const char *file, Source_io_t io, int interleaved, int channels, int passes) {
+    Pcm_source_t src;
+    double t_read = 0, t_shape = 0, t_import = 0;
+    long blocks = 0;
+
+    for(int p = 0; p < passes; p++) {
+        if(pcm_source_open(&src, file, io, sizeof(INT32) * channels) != 0) {
+            perror(file);
+            return;
+        }
+        while(1) {
+            double t0 = now_ns();
+            const INT32 *frames = pcm_source_next(&src, temp, BENCH_BLOCK_SIZE);
+            if(!frames) {
+                break;
+            }
+            double t1 = now_ns();
+            if(!interleaved) {
+                deinterleave_s32(planar, frames, channels, BENCH_BLOCK_SIZE);
+            }
+            double t2 = now_ns();
+            for(int c = 0; c < channels; c++) {
+                if(interleaved) {
+                    aweOS_audioImportSamples(awe, (void *)(frames + c), channels, c, Sample32bit);
+                } else {
+                    aweOS_audioImportSamples(awe, planar + c * BENCH_BLOCK_SIZE, 1, c, Sample32bit);
+                }
+            }
+            double t3 = now_ns();
+            t_read += t1 - t0;
+            t_shape += t2 - t1;
+            t_import += t3 - t2;
+            blocks++;
+        }
+        pcm_source_close(&src);
+    }
+    if(blocks == 0) {
+        fprintf(stderr, "%s: shorter than one block\n", file);
+        return;
+    }
+
+    /*Bytes held per block between read and import*/
+    size_t buffer = 0;
+    if(io != SOURCE_IO_MMAP) {
+        buffer += sizeof(INT32) * channels * BENCH_BLOCK_SIZE;
+    }
+    if(io == SOURCE_IO_URING || io == SOURCE_IO_PREAD) {
+        buffer += sizeof(INT32) * channels * BENCH_BLOCK_SIZE * SOURCE_ASYNC_DEPTH;
+    }
+    if(!interleaved) {
+        buffer += sizeof(INT32) * channels * BENCH_BLOCK_SIZE;
+    }
+    printf("%-6s %-12s %8ld blocks  read %8.0f  reshape %8.0f  import %8.0f  total %8.0f ns/block  buffer %6zu B\n",
+           pcm_source_io_name(io), interleaved ? "interleaved" : "planar", blocks,
+           t_read / blocks, t_shape / blocks, t_import / blocks,
+           (t_read + t_shape + t_import) / blocks, buffer);
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 3) {
+        fprintf(stderr, "Usage: %s <graph.awb> <input.pcm> [channels] [passes]\n", argv[0]);
+        return 1;
+    }
+    int channels = argc > 3 ? atoi(argv[3]) : 2;
+    int passes = argc > 4 ? atoi(argv[4]) : 5;
+    if(channels < 1 || channels > BENCH_MAX_CHANNELS || passes < 1) {
+        fprintf(stderr, "channels must be 1..%d, passes >= 1\n", BENCH_MAX_CHANNELS);
+        return 1;
+    }
+
+    interleave_init(NULL);
+    printf("Interleave kernels: %s\n", interleave_isa());
+
+    AWEOSConfigParameters config;
+    aweOS_getParamDefaults(&config);
+    config.inChannels = channels;
+    config.outChannels = 2;
+    config.sampleRate = 48000;
+    config.fundamentalBlockSize = BENCH_BLOCK_SIZE;
+    int ret = aweOS_init(&awe, &config, moduleDescriptorTable, sizeof(moduleDescriptorTable) / sizeof(moduleDescriptorTable[0]));
+    if(ret < 0) {
+        fprintf(stderr, "aweOS_init: %s\n", aweOS_errorToString(ret));
+        return 1;
+    }
+    UINT32 pos;
+    ret = aweOS_loadAWBFile(awe, argv[1], &pos);
+    if(ret != 0) {
+        fprintf(stderr, "Failed to load AWB graph at pos %u: %s\n", pos, aweOS_errorToString(ret));
+        return 1;
+    }
+
+    /*Warm the page cache so both io modes see the same storage*/
+    run(argv[2], SOURCE_IO_STDIO, 1, channels, 1);
+    printf("--\n");
+    for(int io = SOURCE_IO_STDIO; io <= SOURCE_IO_PREAD; io++) {
+        run(argv[2], (Source_io_t)io, 0, channels, passes);
+        run(argv[2], (Source_io_t)io, 1, channels, passes);
+    }
+
+    aweOS_destroy(&awe);
+    return 0;
+}
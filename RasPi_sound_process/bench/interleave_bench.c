@@ -0,0 +1,72 @@
+/*
+ * Interleave/deinterleave kernel throughput for every ISA this CPU runs.
+ *
+ * Usage: interleave_bench [frames] [iterations]
+ */
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include"interleave.h"
+
+#define BENCH_MAX_CHANNELS 8
+
+static const char *isas[] = { "scalar", "sse2", "avx2", "neon" };
+static const UINT32 channel_counts[] = { 2, 4, 8 };
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    UINT32 frames = argc > 1 ? strtoul(argv[1], NULL, 0) : 768;
+    long iterations = argc > 2 ? atol(argv[2]) : 20000;
+    if(frames == 0 || iterations < 1) {
+        fprintf(stderr, "Usage: %s [frames] [iterations]\n", argv[0]);
+        return 1;
+    }
+    INT32 *in = malloc(sizeof(INT32) * frames * BENCH_MAX_CHANNELS);
+    INT32 *out = malloc(sizeof(INT32) * frames * BENCH_MAX_CHANNELS);
+    if(!in || !out) {
+        return 1;
+    }
+    for(UINT32 i = 0; i < frames * BENCH_MAX_CHANNELS; i++) {
+        in[i] = rand();
+    }
+
+    printf("%-7s %-3s %-5s %12s %12s\n", "isa", "ch", "width", "deint ns", "inter ns");
+    for(size_t k = 0; k < sizeof(isas) / sizeof(isas[0]); k++) {
+        if(interleave_init(isas[k]) != 0) {
+            continue;
+        }
+        for(size_t c = 0; c < sizeof(channel_counts) / sizeof(channel_counts[0]); c++) {
+            UINT32 ch = channel_counts[c];
+            double t0 = now_ns();
+            for(long it = 0; it < iterations; it++) {
+                deinterleave_s32(out, in, ch, frames);
+            }
+            double t1 = now_ns();
+            for(long it = 0; it < iterations; it++) {
+                interleave_s32(out, in, ch, frames);
+            }
+            double t2 = now_ns();
+            for(long it = 0; it < iterations; it++) {
+                deinterleave_s16((INT16 *)out, (const INT16 *)in, ch, frames);
+            }
+            double t3 = now_ns();
+            for(long it = 0; it < iterations; it++) {
+                interleave_s16((INT16 *)out, (const INT16 *)in, ch, frames);
+            }
+            double t4 = now_ns();
+            printf("%-7s %-3u %-5s %12.0f %12.0f\n", isas[k], ch, "s32",
+                   (t1 - t0) / iterations, (t2 - t1) / iterations);
+            printf("%-7s %-3u %-5s %12.0f %12.0f\n", isas[k], ch, "s16",
+                   (t3 - t2) / iterations, (t4 - t3) / iterations);
+        }
+    }
+    free(in);
+    free(out);
+    return 0;
+}
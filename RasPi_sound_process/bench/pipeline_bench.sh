@@ -0,0 +1,85 @@
+#!/bin/sh
+#
+# End-to-end sweep of the native build (make native) over block size, input
+# channels, queue depth, sink and AWE numThreads. Each run appends one summary
+# row (--report) to results.csv in OUTDIR, results.json is made from it.
+#
+# Usage: bench/pipeline_bench.sh [outdir]
+# Lists override the sweep, e.g. BLOCKS="256 768" SINKS=null-clocked:
+#   BLOCKS    frames per block           (default 32 128 768 4096)
+#   CHANNELS  input channels, one source (default 2 4 8)
+#   DEPTHS    ring depth                 (default 2 4 8)
+#   SINKS     null | null-clocked | file (default null null-clocked file)
+#   THREADS   config.numThreads          (default 1 4)
+#   DURATION  seconds of audio per run   (default 2)
+#   RATE      sample rate                (default 48000)
+#   AWE_STUB_COST, AWE_STUB_LAYOUT out channels and any sound_process
+#   options in EXTRA are passed through.
+#
+# Block size and channel count are the stand-in's layout (AWE_STUB_LAYOUT);
+# with the real library they come from the .awb and GRAPH must match them.
+
+BIN=${BIN:-$(dirname "$0")/../bin/native/sound_process}
+OUT=${1:-bench_results}
+BLOCKS=${BLOCKS:-"32 128 768 4096"}
+CHANNELS=${CHANNELS:-"2 4 8"}
+DEPTHS=${DEPTHS:-"2 4 8"}
+SINKS=${SINKS:-"null null-clocked file"}
+THREADS=${THREADS:-"1 4"}
+DURATION=${DURATION:-2}
+RATE=${RATE:-48000}
+OUT_CHANNELS=${OUT_CHANNELS:-2}
+
+if [ ! -x "$BIN" ]; then
+    echo "$BIN not found, run make native first" >&2
+    exit 1
+fi
+mkdir -p "$OUT" || exit 1
+rm -f "$OUT/results.csv" "$OUT/results.json"
+
+GRAPH=${GRAPH:-$OUT/stub.awb}
+[ -f "$GRAPH" ] || : > "$GRAPH"
+
+runs=0
+failed=0
+for ch in $CHANNELS; do
+    input=$OUT/input_${ch}ch.pcm
+    if [ ! -f "$input" ]; then
+        head -c $((RATE * DURATION * ch * 4)) /dev/urandom > "$input" || exit 1
+    fi
+    for block in $BLOCKS; do
+        for depth in $DEPTHS; do
+            for sink in $SINKS; do
+                [ "$sink" = file ] && sink=file:$OUT/render.raw
+                for threads in $THREADS; do
+                    log=$OUT/run_${block}_${ch}_${depth}_${sink%%:*}_${threads}.log
+                    AWE_STUB_LAYOUT=$ch,$OUT_CHANNELS,$block,$RATE \
+                        "$BIN" --sink "$sink" -q "$depth" -t "$threads" -x \
+                        --report "$OUT/results.csv" $EXTRA \
+                        "$input:$ch" "$GRAPH" > "$log" 2>&1
+                    if [ $? -ne 0 ]; then
+                        echo "FAILED block $block ch $ch depth $depth sink $sink threads $threads, see $log" >&2
+                        failed=$((failed + 1))
+                    fi
+                    runs=$((runs + 1))
+                done
+            done
+        done
+    done
+done
+rm -f "$OUT/render.raw"
+
+# CSV -> array of objects keyed by the header, strings quoted
+awk -F, 'NR == 1 { for (i = 1; i <= NF; i++) key[i] = $i; next }
+         { printf "%s  {", (NR > 2 ? ",\n" : "[\n")
+           for (i = 1; i <= NF; i++) {
+               v = $i
+               if (v !~ /^-?[0-9.]+$/) v = "\"" v "\""
+               printf "%s\"%s\": %s", (i > 1 ? ", " : ""), key[i], v
+           }
+           printf "}" }
+         END { print (NR > 1 ? "\n]" : "[]") }' "$OUT/results.csv" > "$OUT/results.json"
+
+echo "$runs runs, $failed failed: $OUT/results.csv $OUT/results.json"
+column -s, -t < "$OUT/results.csv" 2>/dev/null || cat "$OUT/results.csv"
+[ $failed -eq 0 ]
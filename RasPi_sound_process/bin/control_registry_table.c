@@ -0,0 +1,21 @@
+/*Generated by tools/control_registry.awk from ./inc/Kanavi_passthrouh_test_ControlInterface.h, do not edit*/
+#include"control_registry.h"
+
+const Control_object_t control_objects[] = {
+    { "ScalerN2.profileTime", "ScalerN2", 30001, 0xBEEF0814, 0x07531007, 0x00000080, 0x00000001, CONTROL_TYPE_INT, 0, 0, 0, 0 },
+    { "ScalerN2.masterGain", "ScalerN2", 30001, 0xBEEF0814, 0x07531008, 0x00000100, 0x00000001, CONTROL_TYPE_FLOAT, 1, -60, 24, 1 },
+    { "ScalerN2.smoothingTime", "ScalerN2", 30001, 0xBEEF0814, 0x07531009, 0x00000200, 0x00000001, CONTROL_TYPE_FLOAT, 1, 0, 1000, 0 },
+    { "ScalerN2.isDB", "ScalerN2", 30001, 0xBEEF0814, 0x0753100A, 0x00000400, 0x00000001, CONTROL_TYPE_INT, 1, 0, 1, 0 },
+    { "ScalerN2.smoothingCoeff", "ScalerN2", 30001, 0xBEEF0814, 0x0753100B, 0x00000800, 0x00000001, CONTROL_TYPE_FLOAT, 0, 0, 0, 0 },
+    { "ScalerN2.trimGain", "ScalerN2", 30001, 0xBEEF0814, 0x8753100C, 0x00001000, 0x00000004, CONTROL_TYPE_FLOAT, 1, -24, 24, 0 },
+    { "ScalerN2.targetGain", "ScalerN2", 30001, 0xBEEF0814, 0x8753100D, 0x00002000, 0x00000004, CONTROL_TYPE_FLOAT, 0, 0, 0, 0 },
+    { "ScalerN2.currentGain", "ScalerN2", 30001, 0xBEEF0814, 0x8753100E, 0x00004000, 0x00000004, CONTROL_TYPE_FLOAT, 0, 0, 0, 0 },
+    { "Mute1.profileTime", "Mute1", 30002, 0xBEEF081C, 0x07532007, 0x00000080, 0x00000001, CONTROL_TYPE_INT, 0, 0, 0, 0 },
+    { "Mute1.isMuted", "Mute1", 30002, 0xBEEF081C, 0x07532008, 0x00000100, 0x00000001, CONTROL_TYPE_INT, 1, 0, 1, 1 },
+    { "Mute1.smoothingTime", "Mute1", 30002, 0xBEEF081C, 0x07532009, 0x00000200, 0x00000001, CONTROL_TYPE_FLOAT, 1, 0, 1000, 0 },
+    { "Mute1.currentGain", "Mute1", 30002, 0xBEEF081C, 0x0753200A, 0x00000400, 0x00000001, CONTROL_TYPE_FLOAT, 0, 0, 0, 0 },
+    { "Mute1.smoothingCoeff", "Mute1", 30002, 0xBEEF081C, 0x0753200B, 0x00000800, 0x00000001, CONTROL_TYPE_FLOAT, 0, 0, 0, 0 },
+    { "Mute1.gain", "Mute1", 30002, 0xBEEF081C, 0x0753200C, 0x00001000, 0x00000001, CONTROL_TYPE_FLOAT, 0, 0, 0, 0 },
+    { NULL }
+};
+const UINT32 control_object_count = 14;
@@ -0,0 +1,518 @@
+const int awe_modAGCCoreClass;
+const int awe_modAGCLimiterCoreClass;
+const int awe_modAGCLimiterCoreFract32Class;
+const int awe_modAGCLimiterCoreV2Class;
+const int awe_modAGCLimiterCoreV2Fract32Class;
+const int awe_modAGCMultiplierFract32Class;
+const int awe_modAGCNoiseGateCoreClass;
+const int awe_modAbsClass;
+const int awe_modAbsFract32Class;
+const int awe_modAcosClass;
+const int awe_modAdderClass;
+const int awe_modAdderFract32Class;
+const int awe_modAdderInt32Class;
+const int awe_modAsinClass;
+const int awe_modAtanClass;
+const int awe_modAtan2Class;
+const int awe_modBalanceClass;
+const int awe_modBalanceFract32Class;
+const int awe_modBiquadClass;
+const int awe_modBiquadCascadeClass;
+const int awe_modBiquadCascadeFract32Class;
+const int awe_modBiquadFract32Class;
+const int awe_modBiquadNCascadeClass;
+const int awe_modBiquadSmoothedClass;
+const int awe_modBiquadSmoothedFract32Class;
+const int awe_modBiquadV2Fract32Class;
+const int awe_modBitsToIntClass;
+const int awe_modBlockCounterClass;
+const int awe_modBooleanInvertClass;
+const int awe_modBooleanSinkClass;
+const int awe_modBooleanSourceClass;
+const int awe_modButterworthFilterClass;
+const int awe_modButterworthFilterFract32Class;
+const int awe_modCeilClass;
+const int awe_modClipAsymClass;
+const int awe_modClipAsymFract32Class;
+const int awe_modClipAsymInt32Class;
+const int awe_modClipIndicatorClass;
+const int awe_modClipIndicatorFract32Class;
+const int awe_modCopierClass;
+const int awe_modCosClass;
+const int awe_modCoshClass;
+const int awe_modCounterClass;
+const int awe_modCrossFaderClass;
+const int awe_modDCSourceIntClass;
+const int awe_modDCSourceV2Class;
+const int awe_modDCSourceV2Fract32Class;
+const int awe_modDb10Class;
+const int awe_modDb10ApproxClass;
+const int awe_modDb10Fract32Class;
+const int awe_modDb20Class;
+const int awe_modDb20ApproxClass;
+const int awe_modDb20Fract32Class;
+const int awe_modDcBlockClass;
+const int awe_modDebounceClass;
+const int awe_modDeinterleaveClass;
+const int awe_modDelayClass;
+const int awe_modDelayMsecClass;
+const int awe_modDivideClass;
+const int awe_modExpClass;
+const int awe_modFIRClass;
+const int awe_modFIRFract32Class;
+const int awe_modFIRSmoothedClass;
+const int awe_modFloorClass;
+const int awe_modFmodClass;
+const int awe_modFrexpClass;
+const int awe_modGPIOClass;
+const int awe_modGraphicEQBandClass;
+const int awe_modGraphicEQBandFract32Class;
+const int awe_modImpulseMsecSourceClass;
+const int awe_modImpulseMsecSourceFract32Class;
+const int awe_modImpulseSourceFract32Class;
+const int awe_modIntToBitsClass;
+const int awe_modInterleaveClass;
+const int awe_modInvertClass;
+const int awe_modInvertFract32Class;
+const int awe_modLShiftFract32Class;
+const int awe_modLdexpClass;
+const int awe_modLinkwitzRileyFilterClass;
+const int awe_modLogClass;
+const int awe_modLog10Class;
+const int awe_modLog10Fract32Class;
+const int awe_modLog2Class;
+const int awe_modLog2Fract32Class;
+const int awe_modLogicAllClass;
+const int awe_modLogicAndConstFract32Class;
+const int awe_modLogicAndConstInt32Class;
+const int awe_modLogicAnyClass;
+const int awe_modLogicBinaryOpClass;
+const int awe_modLogicCompareClass;
+const int awe_modLogicCompareConstClass;
+const int awe_modLogicCompareConstFract32Class;
+const int awe_modLogicCompareConstInt32Class;
+const int awe_modLogicCompareConstReplaceClass;
+const int awe_modLogicCompareConstReplaceInt32Class;
+const int awe_modLogicCompareFract32Class;
+const int awe_modLogicCompareInt32Class;
+const int awe_modMaxAbsClass;
+const int awe_modMaxAbsFract32Class;
+const int awe_modMeterClass;
+const int awe_modMeterFract32Class;
+const int awe_modMixerDenseFract32Class;
+const int awe_modMixerFract32Class;
+const int awe_modMixerSmoothedFract32Class;
+const int awe_modMixerV3Class;
+const int awe_modMixerV3Fract32Class;
+const int awe_modModfClass;
+const int awe_modMultiplexorClass;
+const int awe_modMultiplexorV2Class;
+const int awe_modMultiplexorV2Fract32Class;
+const int awe_modMultiplierFract32Class;
+const int awe_modMultiplierV2Class;
+const int awe_modMultiplierV2Fract32Class;
+const int awe_modMuteNSmoothedClass;
+const int awe_modMuteNSmoothedFract32Class;
+const int awe_modMuteSmoothedClass;
+const int awe_modMuteSmoothedFract32Class;
+const int awe_modMuteUnmuteClass;
+const int awe_modMuteUnmuteFract32Class;
+const int awe_modNullSinkClass;
+const int awe_modNullSinkV2Class;
+const int awe_modNullSourceClass;
+const int awe_modParamGetClass;
+const int awe_modParamSetClass;
+const int awe_modPeriodicFunctionGenClass;
+const int awe_modPeriodicSourceClass;
+const int awe_modPeriodicSourceFract32Class;
+const int awe_modPolynomialClass;
+const int awe_modPolynomialFract32Class;
+const int awe_modPowClass;
+const int awe_modPow10toXClass;
+const int awe_modPow2Fract32Class;
+const int awe_modPowFract32Class;
+const int awe_modPulseGenClass;
+const int awe_modPulseGenFract32Class;
+const int awe_modRMSClass;
+const int awe_modRMSFract32Class;
+const int awe_modRMSNClass;
+const int awe_modRandClass;
+const int awe_modReciprocalClass;
+const int awe_modReciprocalFract32Class;
+const int awe_modRemainderClass;
+const int awe_modRoundClass;
+const int awe_modRouterClass;
+const int awe_modRouterSmoothedClass;
+const int awe_modRouterSmoothedFract32Class;
+const int awe_modSMixer2x1Class;
+const int awe_modSMixer2x1Fract32Class;
+const int awe_modSOFSmoothedCascadeFract32Class;
+const int awe_modSawtoothFract32Class;
+const int awe_modScaleOffsetClass;
+const int awe_modScaleOffsetFract32Class;
+const int awe_modScaleOffsetInt32Class;
+const int awe_modScalerControlClass;
+const int awe_modScalerControlBlockSmoothedFract32Class;
+const int awe_modScalerControlSmoothedFract32Class;
+const int awe_modScalerDBControlClass;
+const int awe_modScalerDBFract32Class;
+const int awe_modScalerDBSmoothedFract32Class;
+const int awe_modScalerFract32Class;
+const int awe_modScalerNControlClass;
+const int awe_modScalerNDBSmoothedFract32Class;
+const int awe_modScalerNFract32Class;
+const int awe_modScalerNSmoothedFract32Class;
+const int awe_modScalerNSymmetricFadingClass;
+const int awe_modScalerNV2Class;
+const int awe_modScalerSmoothedFract32Class;
+const int awe_modScalerSymmetricFadingClass;
+const int awe_modScalerSymmetricFadingV2Class;
+const int awe_modScalerV2Class;
+const int awe_modSecondOrderFilterSmoothedClass;
+const int awe_modSecondOrderFilterSmoothedCascadeClass;
+const int awe_modSecondOrderFilterSmoothedCascadeV2Class;
+const int awe_modSecondOrderFilterSmoothedFract32Class;
+const int awe_modShiftFract32Class;
+const int awe_modSignClass;
+const int awe_modSinClass;
+const int awe_modSineGenControlFract32Class;
+const int awe_modSineGenFract32Class;
+const int awe_modSineSmoothedGenClass;
+const int awe_modSineSmoothedGenFract32Class;
+const int awe_modSinhClass;
+const int awe_modSinkClass;
+const int awe_modSinkFract32Class;
+const int awe_modSinkFract32PropertiesClass;
+const int awe_modSinkIntClass;
+const int awe_modSinkIntPropertiesClass;
+const int awe_modSinkPropertiesClass;
+const int awe_modSofV2HpFract32Class;
+const int awe_modSoftClipClass;
+const int awe_modSoftClipFract32Class;
+const int awe_modSoloMuteClass;
+const int awe_modSoloMuteFract32Class;
+const int awe_modSourceClass;
+const int awe_modSourceFract32Class;
+const int awe_modSourceFract32PropertiesClass;
+const int awe_modSourceIntClass;
+const int awe_modSourceIntPropertiesClass;
+const int awe_modSourcePropertiesClass;
+const int awe_modSqrtClass;
+const int awe_modSqrtFract32Class;
+const int awe_modSquareClass;
+const int awe_modSquareAddClass;
+const int awe_modSquareAddFract32Class;
+const int awe_modSquareFract32Class;
+const int awe_modSubtractClass;
+const int awe_modSubtractFract32Class;
+const int awe_modSubtractInt32Class;
+const int awe_modSumDiffClass;
+const int awe_modSumDiffFract32Class;
+const int awe_modSumDiffInt32Class;
+const int awe_modTableInterpClass;
+const int awe_modTableInterpFract32Class;
+const int awe_modTableLookupClass;
+const int awe_modTableLookupV2Class;
+const int awe_modTanClass;
+const int awe_modTanhClass;
+const int awe_modThreeBandToneControlClass;
+const int awe_modThreeBandToneControlFract32Class;
+const int awe_modToggleButtonClass;
+const int awe_modTypeConversionClass;
+const int awe_modUndb10Class;
+const int awe_modUndb10ApproxClass;
+const int awe_modUndb10Fract32Class;
+const int awe_modUndb20Class;
+const int awe_modUndb20ApproxClass;
+const int awe_modUndb20Fract32Class;
+const int awe_modVolumeControlClass;
+const int awe_modVolumeControlFract32Class;
+const int awe_modWetDryClass;
+const int awe_modWhiteNoiseClass;
+const int awe_modWhiteNoiseFract32Class;
+const int awe_modWithinRangeClass;
+const int awe_modWithinRangeFract32Class;
+const int awe_modZeroCrossingDetectorClass;
+const int awe_modZeroCrossingDetectorFract32Class;
+const int awe_modZeroSourceClass;
+const int awe_modAGCAttackReleaseClass;
+const int awe_modAGCAttackReleaseFract32Class;
+const int awe_modAGCCompressorCoreClass;
+const int awe_modAGCCompressorCoreFract32Class;
+const int awe_modAGCCoreFract32Class;
+const int awe_modAGCVariableAttackReleaseClass;
+const int awe_modAllpassDelayClass;
+const int awe_modAllpassDelay16Class;
+const int awe_modAllpassDelay16Fract32Class;
+const int awe_modAllpassDelayFract32Class;
+const int awe_modAllpassDelayciClass;
+const int awe_modAllpassDelayiClass;
+const int awe_modArraysetClass;
+const int awe_modAttackDecaySustainReleaseClass;
+const int awe_modAudioWeightingClass;
+const int awe_modAudioWeightingFract32Class;
+const int awe_modAveragerClass;
+const int awe_modAveragerFract32Class;
+const int awe_modBandToBinClass;
+const int awe_modBinToBandClass;
+const int awe_modBiquadCascadeHPClass;
+const int awe_modBiquadCascadeHPFract32Class;
+const int awe_modBiquadLoadingClass;
+const int awe_modBiquadLoadingFract32Class;
+const int awe_modBiquadSmoothedHPClass;
+const int awe_modBiquadSparseClass;
+const int awe_modBiquadSparseHPClass;
+const int awe_modBiquadSparseHPFract32Class;
+const int awe_modBiquadSparseV2Class;
+const int awe_modBiquadSparseV3Class;
+const int awe_modBiquadSparseV4Class;
+const int awe_modBiquadSparseV5Class;
+const int awe_modBiquadSparseV6Class;
+const int awe_modBlockConcatenateClass;
+const int awe_modBlockDelayClass;
+const int awe_modBlockDelayV2Class;
+const int awe_modBlockExtractClass;
+const int awe_modBlockFlipClass;
+const int awe_modBlockMedianClass;
+const int awe_modBlockStatisticsClass;
+const int awe_modBlockStatisticsFract32Class;
+const int awe_modBlockStatisticsNClass;
+const int awe_modButterworthFilterHPClass;
+const int awe_modCfftClass;
+const int awe_modCfftFract32Class;
+const int awe_modCoeffTableClass;
+const int awe_modComplexAngleClass;
+const int awe_modComplexConjugateClass;
+const int awe_modComplexConjugateFract32Class;
+const int awe_modComplexDivideClass;
+const int awe_modComplexMagnitudeClass;
+const int awe_modComplexMagnitudeFract32Class;
+const int awe_modComplexMagnitudeSquaredClass;
+const int awe_modComplexModulateClass;
+const int awe_modComplexMultiplierClass;
+const int awe_modComplexMultiplierFract32Class;
+const int awe_modComplexMultiplierV2Class;
+const int awe_modComplexToPolarClass;
+const int awe_modComplexToRealImagClass;
+const int awe_modComplexToRealImagFract32Class;
+const int awe_modConsecutiveCountIntClass;
+const int awe_modConvolveClass;
+const int awe_modCorrelateClass;
+const int awe_modCorrelationFract32Class;
+const int awe_modCycleBurnerClass;
+const int awe_modCycleBurnerSetClass;
+const int awe_modDateTimeClass;
+const int awe_modDeadBandClass;
+const int awe_modDelay16Class;
+const int awe_modDelayInterpClass;
+const int awe_modDelayInterpFract32Class;
+const int awe_modDelayMixerSmoothedClass;
+const int awe_modDelayNChanClass;
+const int awe_modDelayNChanMsecClass;
+const int awe_modDelayNChanMsecSmoothedClass;
+const int awe_modDelayNChanSmoothedClass;
+const int awe_modDelayNChanV2Class;
+const int awe_modDelayNTapClass;
+const int awe_modDelayNTap16Fract32Class;
+const int awe_modDelayReaderClass;
+const int awe_modDelayStateWriterClass;
+const int awe_modDelayStateWriter16Class;
+const int awe_modDelayciFract32Class;
+const int awe_modDerivativeClass;
+const int awe_modDerivativeFract32Class;
+const int awe_modDitherFract32Class;
+const int awe_modDownsamplerClass;
+const int awe_modDownwardExpanderCoreClass;
+const int awe_modDownwardExpanderCoreFract32Class;
+const int awe_modDuckerClass;
+const int awe_modDuckerFract32Class;
+const int awe_modEmphasisFilterClass;
+const int awe_modEmphasisFilterFract32Class;
+const int awe_modExpanderCoreClass;
+const int awe_modFIRDecimatorClass;
+const int awe_modFIRDecimatorFract32Class;
+const int awe_modFIRInterpolatorClass;
+const int awe_modFIRInterpolatorFract32Class;
+const int awe_modFIRLoadingClass;
+const int awe_modFIRLoadingFract32Class;
+const int awe_modFIRNChanClass;
+const int awe_modFIRReaderClass;
+const int awe_modFIRSparseClass;
+const int awe_modFIRSparseReaderClass;
+const int awe_modFIRSparseReaderFract16Class;
+const int awe_modFIRSparseReaderFract32Class;
+const int awe_modFOFControlClass;
+const int awe_modFOFControlFract32Class;
+const int awe_modFftClass;
+const int awe_modFftFract32Class;
+const int awe_modFileSinkClass;
+const int awe_modFilterbankFIRNChanClass;
+const int awe_modFilterbankFIRNChanV2Class;
+const int awe_modFractionalDelayV2Class;
+const int awe_modFractionalDelayV2Fract32Class;
+const int awe_modGetWirePropertiesClass;
+const int awe_modGraphicEQBandHPClass;
+const int awe_modGraphicEQBandHpFract32Class;
+const int awe_modHistogramClass;
+const int awe_modHysteresisClass;
+const int awe_modHysteresisFract32Class;
+const int awe_modIfftClass;
+const int awe_modIfftFract32Class;
+const int awe_modIntegralClass;
+const int awe_modInterleavedSinkClass;
+const int awe_modInvertNClass;
+const int awe_modLMSClass;
+const int awe_modLMSNormFract32Class;
+const int awe_modLPF1ControlClass;
+const int awe_modMapperControlClass;
+const int awe_modMathExceptionClass;
+const int awe_modMatrixMultiplicationClass;
+const int awe_modMeasurementClass;
+const int awe_modMeasurementV2Class;
+const int awe_modMemoryLoadingClass;
+const int awe_modMultichannelMixerSmoothedClass;
+const int awe_modMuteLinearFadeClass;
+const int awe_modMuteSymmetricClass;
+const int awe_modMuteSyncClass;
+const int awe_modMuteSyncFract32Class;
+const int awe_modOscillatorClass;
+const int awe_modOverlapAddClass;
+const int awe_modOverlapAddFract32Class;
+const int awe_modOverwriteControlClass;
+const int awe_modPDFClass;
+const int awe_modParamSetTableV2Class;
+const int awe_modPeakFinderClass;
+const int awe_modPeriodicStreamingClass;
+const int awe_modPolarToComplexClass;
+const int awe_modPresetArrayHandlerClass;
+const int awe_modPresetArrayHandlerV2Class;
+const int awe_modProbeFract32Class;
+const int awe_modRandiClass;
+const int awe_modRandiFract32Class;
+const int awe_modRealImagToComplexClass;
+const int awe_modRealImagToComplexFract32Class;
+const int awe_modRebufferClass;
+const int awe_modRepWinOverlapClass;
+const int awe_modRepWinOverlapFract32Class;
+const int awe_modRunningMinMaxClass;
+const int awe_modRunningMinMaxFract32Class;
+const int awe_modRunningStatisticsClass;
+const int awe_modRunningStatisticsFract32Class;
+const int awe_modRunningStatisticsNClass;
+const int awe_modSOFCascadeHPClass;
+const int awe_modSOFCascadeHPFract32Class;
+const int awe_modSOFControlClass;
+const int awe_modSOFControlFract32Class;
+const int awe_modSOFControlHPClass;
+const int awe_modSOFControlV2Class;
+const int awe_modSOFControlV3Class;
+const int awe_modSampleAndHoldClass;
+const int awe_modSampleAndHoldInt32Class;
+const int awe_modSampleMultiplexorControlClass;
+const int awe_modSampleRateClass;
+const int awe_modSampleStatisticsClass;
+const int awe_modSampleStatisticsFract32Class;
+const int awe_modSbAttackReleaseClass;
+const int awe_modSbComplexFIRClass;
+const int awe_modSbComplexFIRvlClass;
+const int awe_modSbDerivativeClass;
+const int awe_modSbNLMSClass;
+const int awe_modSbNLMSV2Class;
+const int awe_modSbNLMSV3Class;
+const int awe_modSbRMSClass;
+const int awe_modSbSOFClass;
+const int awe_modSbSmoothClass;
+const int awe_modSbSmoothFract32Class;
+const int awe_modSbSmoothV2Class;
+const int awe_modSbSplitterClass;
+const int awe_modSecondOrderFilterHPClass;
+const int awe_modSetWirePropertiesClass;
+const int awe_modShiftSamplesClass;
+const int awe_modSlewRateLimiterClass;
+const int awe_modStatusSetClass;
+const int awe_modStatusSetV2Class;
+const int awe_modSubblockStatisticsClass;
+const int awe_modSubblockStatisticsFract32Class;
+const int awe_modSweepGenClass;
+const int awe_modSystemVariableClass;
+const int awe_modTHDClass;
+const int awe_modTableInterp2dClass;
+const int awe_modTableLookupIntFloatClass;
+const int awe_modTableLookupIntIntClass;
+const int awe_modTableLookupLogXClass;
+const int awe_modTableSourceV2Class;
+const int awe_modTablesourceClass;
+const int awe_modTimeOutClass;
+const int awe_modTimeOutFract32Class;
+const int awe_modTriggeredFileSinkClass;
+const int awe_modTriggeredPulseClass;
+const int awe_modTriggeredPulseV2Class;
+const int awe_modTriggeredSinkClass;
+const int awe_modTwoPieceInterpV2Class;
+const int awe_modUnwrapClass;
+const int awe_modUpFIRDnConverterClass;
+const int awe_modUpdateSampleRateClass;
+const int awe_modUpsamplerClass;
+const int awe_modVolumeControlHPClass;
+const int awe_modWAVInterp16OneShotSourceFract32Class;
+const int awe_modWAVInterpOneShotSourceClass;
+const int awe_modWaveFileSinkClass;
+const int awe_modWaveFileSourceClass;
+const int awe_modWindowClass;
+const int awe_modWindowAliasClass;
+const int awe_modWindowAliasFract32Class;
+const int awe_modWindowCustomClass;
+const int awe_modWindowFract32Class;
+const int awe_modWindowOverlapClass;
+const int awe_modWindowOverlapFract32Class;
+const int awe_modWindowV2Class;
+const int awe_modZeroPaddingClass;
+const int awe_modZeroPaddingFract32Class;
+const int awe_modAGCMultiplierClass;
+const int awe_modApplyPresetClass;
+const int awe_modDCSourceClass;
+const int awe_modDCSourceControlClass;
+const int awe_modDCSourceControlFract32Class;
+const int awe_modDCSourceFract32Class;
+const int awe_modDeMultiplexorClass;
+const int awe_modDelayciClass;
+const int awe_modDelayiClass;
+const int awe_modFileStreamingClass;
+const int awe_modFloatToFract32Class;
+const int awe_modFloatToIntClass;
+const int awe_modFract32ToFloatClass;
+const int awe_modFract32ToIntClass;
+const int awe_modImpulseSourceClass;
+const int awe_modIntToFloatClass;
+const int awe_modIntToFract32Class;
+const int awe_modMatlabStreamingClass;
+const int awe_modMixerClass;
+const int awe_modMixerDenseClass;
+const int awe_modMixerSmoothedClass;
+const int awe_modMixerSmoothedV2bClass;
+const int awe_modMixerSparseSmoothedClass;
+const int awe_modMultiplexorControlClass;
+const int awe_modMultiplexorFadeClass;
+const int awe_modMultiplexorFadeFract32Class;
+const int awe_modMultiplexorSmoothedClass;
+const int awe_modMultiplexorSmoothedFract32Class;
+const int awe_modMultiplierClass;
+const int awe_modProbeClass;
+const int awe_modRawStreamingSourceClass;
+const int awe_modSawtoothClass;
+const int awe_modScalerClass;
+const int awe_modScalerDBClass;
+const int awe_modScalerDBSmoothedClass;
+const int awe_modScalerNClass;
+const int awe_modScalerNDBSmoothedClass;
+const int awe_modScalerNSmoothedClass;
+const int awe_modScalerSmoothedClass;
+const int awe_modSineGenClass;
+const int awe_modTableInterpRuntimeClass;
+const int awe_modTwoPieceInterpClass;
+const int awe_modCompiledSubsystemClass;
+const int awe_modFifoInClass;
+const int awe_modFifoOutClass;
+const int awe_modIPCFifoInClass;
+const int awe_modIPCFifoOutClass;
+const int awe_modProxyGetSetClass;
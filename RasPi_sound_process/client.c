@@ -23,8 +23,8 @@ void chat_func(int server_fd)
         printf("Please enter the message: ");
         fgets(sendbuff, BUFF_SIZE, stdin);
 
-        /* Gửi thông điệp tới server bằng hàm write */
-        numb_write = send(server_fd, sendbuff, sizeof(sendbuff), 0);
+        /* Gửi thông điệp tới server bằng hàm write, server tách lệnh theo '\n' */
+        numb_write = send(server_fd, sendbuff, strlen(sendbuff), 0);
         if (numb_write == -1)     
             handle_error("write()");
         if (strncmp("exit", sendbuff, 4) == 0) {
@@ -33,7 +33,7 @@ void chat_func(int server_fd)
         }
 		
         /* Nhận thông điệp từ server bằng hàm read */
-        numb_read = read(server_fd, recvbuff, sizeof(recvbuff));
+        numb_read = read(server_fd, recvbuff, sizeof(recvbuff) - 1);
         if (numb_read < 0) {
             handle_error("read()");
         }
@@ -0,0 +1,85 @@
+#ifndef __AUDIO_SINK_H__
+#define __AUDIO_SINK_H__
+
+#include"StandardDefs.h"
+#include"External/alsa/asoundlib.h"
+#include"render.h"
+
+/*Where sound_processing sends each pumped block*/
+typedef enum {
+    SINK_ALSA,         //snd_pcm_writei
+    SINK_ALSA_MMAP,    //export straight into the mmap DMA ring
+    SINK_FILE,         //.wav or raw S32_LE, as fast as possible
+    SINK_NULL,         //discard, as fast as possible
+    SINK_NULL_CLOCKED, //discard, paced by a simulated device clock
+} Sink_type_t;
+
+/*Buffering presets, period/periods/start threshold in pcm_profiles*/
+typedef enum {
+    PCM_PROFILE_SAFE,        //4 block periods, start on a full buffer
+    PCM_PROFILE_BALANCED,    //3 block periods, start at 2 blocks
+    PCM_PROFILE_LOW_LATENCY, //4 half-block periods (2 blocks buffered), start at 1 block
+} Pcm_profile_t;
+
+typedef struct {
+    snd_pcm_t *dev;
+    snd_pcm_access_t access;
+    snd_pcm_uframes_t period_size;
+    snd_pcm_uframes_t buffer_size;
+    snd_pcm_uframes_t start_threshold;
+    snd_pcm_uframes_t avail_min;
+    INT32 *silence;   //one block, prefill after an xrun
+} PCM_device_t;
+
+/*Simulated device: plays sample_rate frames a second from start_ns on*/
+typedef struct {
+    UINT64 start_ns;
+    UINT64 written;        //frames queued since the clock (re)started
+    UINT32 period_frames;
+    UINT32 buffer_frames;
+    UINT32 start_frames;
+    int running;
+} Sink_clock_t;
+
+typedef struct Audio_sink Audio_sink_t;
+
+typedef struct {
+    int (*open)(Audio_sink_t *sink);
+    int (*write)(Audio_sink_t *sink);  //export the pumped block and queue it
+    void (*drain)(Audio_sink_t *sink); //let queued audio play out
+    void (*close)(Audio_sink_t *sink);
+} Audio_sink_ops_t;
+
+struct Audio_sink {
+    Sink_type_t type;
+    const Audio_sink_ops_t *ops;
+    const char *path;  //file sink
+    UINT64 frames;     //written so far
+    PCM_device_t pcm;
+    Render_file_t file;
+    Sink_clock_t clock;
+};
+
+/*ALSA and the clocked null sink pace the pipeline; file and null run flat out*/
+static inline int sink_is_clocked(Sink_type_t type) {
+    return type == SINK_ALSA || type == SINK_ALSA_MMAP || type == SINK_NULL_CLOCKED;
+}
+
+/*"alsa", "alsa-mmap", "null", "null-clocked" or "file:PATH"*/
+int sink_parse(const char *spec, Sink_type_t *type, const char **path);
+const char *sink_name(Sink_type_t type);
+
+int sink_open(Audio_sink_t *sink, Sink_type_t type, const char *path);
+int sink_write(Audio_sink_t *sink);
+void sink_drain(Audio_sink_t *sink);
+void sink_close(Audio_sink_t *sink);
+
+int pcm_parse_profile(const char *name, Pcm_profile_t *profile);
+const char *pcm_profile_name(Pcm_profile_t profile);
+int sink_block_aligned(unsigned long frames);
+/*Requested period/periods from profile and overrides, start 0 = full buffer*/
+int sink_buffer_geometry(UINT32 *period, UINT32 *periods, UINT32 *start);
+
+extern const Audio_sink_ops_t sink_alsa_ops; //sink_alsa.c
+
+#endif /*__AUDIO_SINK_H__*/
@@ -0,0 +1,76 @@
+#ifndef __BLOCK_RING_H__
+#define __BLOCK_RING_H__
+
+#include<stddef.h>
+#include<stdatomic.h>
+#include"StandardDefs.h"
+
+#define RING_CACHE_LINE 64
+#define RING_MIN_DEPTH 2
+#define RING_MAX_DEPTH 64
+
+/*
+ * Lock-free single-producer/single-consumer ring of whole audio blocks.
+ * The producer fills a slot in place and commits it, the consumer reads a
+ * slot in place and releases it. Indices only ever grow; slot = index % depth.
+ *
+ * Watermarks: the producer stops once fill reaches high and resumes when it
+ * has dropped to low, so reads come in bursts; the consumer starts only when
+ * every ring holds high blocks (prefill).
+ */
+typedef struct {
+    _Alignas(RING_CACHE_LINE) atomic_uint head;   /*written by producer only*/
+    UINT32 tail_cache;                            /*producer's view of tail*/
+    int paused;                                   /*producer above high watermark*/
+    atomic_uint full_waits;                       /*producer had to wait for space*/
+    atomic_uint max_fill;
+    _Alignas(RING_CACHE_LINE) atomic_uint tail;   /*written by consumer only*/
+    UINT32 head_cache;                            /*consumer's view of head*/
+    atomic_uint underruns;                        /*consumer found the ring empty*/
+    atomic_uint low_water_hits;                   /*consumer saw fill below low*/
+    atomic_uint min_fill;
+    _Alignas(RING_CACHE_LINE) atomic_int closed;  /*producer reached end of stream*/
+    UINT32 depth;
+    UINT32 high;
+    UINT32 low;
+    size_t block_bytes;
+    unsigned char *data;
+} Block_ring_t;
+
+/*Snapshot of the fill-level counters*/
+typedef struct {
+    UINT32 depth;
+    UINT32 fill;
+    UINT32 min_fill;
+    UINT32 max_fill;
+    UINT32 underruns;
+    UINT32 low_water_hits;
+    UINT32 full_waits;
+    UINT32 blocks;
+} Ring_stats_t;
+
+/*Setup, teardown. high/low of 0 pick depth and depth / 2*/
+int ring_init(Block_ring_t *ring, UINT32 depth, UINT32 high, UINT32 low, size_t block_bytes);
+void ring_free(Block_ring_t *ring);
+
+/*Producer side: NULL when the ring is full*/
+void *ring_write_begin(Block_ring_t *ring);
+void *ring_write_wait(Block_ring_t *ring, long sleep_ns);
+void ring_write_commit(Block_ring_t *ring);
+void ring_close(Block_ring_t *ring);
+
+/*Consumer side: NULL when the ring is empty*/
+void *ring_read_begin(Block_ring_t *ring);
+void ring_read_release(Block_ring_t *ring);
+void ring_account_read(Block_ring_t *ring);
+int ring_is_primed(Block_ring_t *ring);
+int ring_is_drained(Block_ring_t *ring);
+
+/*Safe from any thread*/
+UINT32 ring_fill(Block_ring_t *ring);
+void ring_get_stats(Block_ring_t *ring, Ring_stats_t *stats);
+
+/*Spin, then yield, then sleep sleep_ns; *spins counts calls since last success*/
+void ring_backoff(unsigned *spins, long sleep_ns);
+
+#endif /*__BLOCK_RING_H__*/
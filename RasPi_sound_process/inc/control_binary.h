@@ -0,0 +1,49 @@
+#ifndef __CONTROL_BINARY_H__
+#define __CONTROL_BINARY_H__
+
+#include<stddef.h>
+#include"StandardDefs.h"
+#include"control_queue.h"
+
+/*
+ * Binary control frames, on the same socket as the text lines: a frame
+ * starts with CONTROL_FRAME_MAGIC, which no text command does. Little-endian.
+ *
+ * Request  header {u8 magic, u8 version, u16 op_count, u32 payload_len}
+ *          op_count x {u8 op, u8 flags, u16 count, u32 handle, u32 offset,
+ *                      [u32 mask if CONTROL_OP_MASKED], [count words if set]}
+ * Reply    header, then {i32 status, u32 reserved, u64 block}
+ *          op_count x {i32 status, u16 count, u16 flags, [count words if get]}
+ *
+ * A frame is checked against the control registry as a whole: on any error
+ * the reply carries only the frame status and nothing was applied. Its sets
+ * go in as one control queue group, so they take effect in the same block,
+ * and its gets are read after that, they see the frame's own sets. block is
+ * that block, 0 without sets.
+ */
+#define CONTROL_FRAME_MAGIC 0xAE
+#define CONTROL_FRAME_VERSION 1
+#define CONTROL_FRAME_HEADER 8
+#define CONTROL_FRAME_MAX TCP_BUFF_SIZE //request or reply, header included
+
+typedef enum {
+    CONTROL_OP_GET = 1,
+    CONTROL_OP_SET = 2,
+} Control_op_t;
+
+#define CONTROL_OP_MASKED 0x01    //request flags: aweOS_ctrl{Set,Get}ValueMask with the mask word
+#define CONTROL_OP_COALESCED 0x01 //reply flags: a later set in the same block won
+
+/*Reply to a frame that was CONTROL_REPLY_LATER*/
+typedef void (*Control_frame_done_t)(const UINT8 *reply, size_t len, void *user);
+
+/*Bytes of the frame at buf, 0 while its header is incomplete, -1 if it's no frame we take*/
+long control_frame_size(const UINT8 *buf, size_t len);
+/*Reply length, or CONTROL_REPLY_LATER when done gets it once the sets are acked*/
+int control_frame(const UINT8 *frame, size_t len, UINT8 *reply, size_t reply_len, Control_frame_done_t done,
+                  void *user);
+/*Reply with only a frame status*/
+int control_frame_error(INT32 status, UINT8 *reply, size_t reply_len);
+int format_frame_stats(char *buf, size_t len);
+
+#endif /*__CONTROL_BINARY_H__*/
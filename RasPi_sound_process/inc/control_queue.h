@@ -0,0 +1,72 @@
+#ifndef __CONTROL_QUEUE_H__
+#define __CONTROL_QUEUE_H__
+
+#include<stddef.h>
+#include"StandardDefs.h"
+
+/*
+ * Control writes into the audio thread. Any thread submits into a bounded
+ * lock-free MPSC ring, sound_processing applies what's queued at the next
+ * block boundary (between wait and import) so no write races
+ * aweOS_audioPumpAll. Writes to the same handle/offset in one drain are
+ * coalesced, the last one wins. Every command is acked exactly once with the
+ * block it took effect in; acks are reaped on the control thread, which
+ * control_queue_fd() wakes up.
+ */
+#define CONTROL_QUEUE_SIZE 256 //commands in flight until reaped, power of two
+#define CONTROL_DRAIN_MAX 32   //applied per block, the rest wait for the next one
+#define CONTROL_MAX_WORDS 16
+#define CONTROL_BATCH_MAX 64   //writes submitted as one group, all applied in the same block
+
+/*control_command: the reply comes later, through the ack*/
+#define CONTROL_REPLY_LATER (-2)
+
+typedef enum {
+    CONTROL_APPLIED,
+    CONTROL_COALESCED, //a later write to the same handle in that block won
+    CONTROL_FAILED,    //aweOS_ctrlSetValue error, in error
+} Control_status_t;
+
+typedef struct {
+    UINT32 handle;
+    UINT32 offset; //arrayOffset
+    UINT32 count;  //words, 1..CONTROL_MAX_WORDS
+    INT32 value[CONTROL_MAX_WORDS]; //as aweOS_ctrlSetValue takes them, floats by their bits
+    UINT32 mask;       //aweOS_ctrlSetValueMask when masked
+    UINT8 masked;
+    UINT16 group_left; //writes after this one in its group, set by control_submit_batch
+} Control_write_t;
+
+typedef struct {
+    unsigned long ticket;
+    UINT64 block;           //first block pumped with the value
+    Control_status_t status;
+    INT32 error;
+    UINT64 latency_ns;      //submit to applied
+} Control_ack_t;
+
+typedef void (*Control_done_t)(const Control_ack_t *ack, void *user);
+
+int control_queue_init(void);
+int control_queue_fd(void); //eventfd, readable once acks are ready
+
+/*Ticket, or -1 when CONTROL_QUEUE_SIZE commands are in flight. done may be NULL*/
+long control_submit(const Control_write_t *write, Control_done_t done, void *user);
+/*
+ * count writes as one group on consecutive tickets, never split across
+ * blocks; done is called for each. First ticket, or -1 when they don't fit.
+ */
+long control_submit_batch(Control_write_t *writes, UINT32 count, Control_done_t done, void *user);
+/*Control thread: calls done for everything applied, in submit order*/
+void control_reap(void);
+
+/*Audio thread, at a block boundary*/
+void control_apply(UINT64 block);
+/*Audio thread, once it stops pumping: later commands apply from control_reap*/
+void control_queue_shutdown(UINT64 block);
+
+/*"OK block N" / "OK block N (coalesced)" / the aweOS error*/
+int control_format_ack(const Control_ack_t *ack, char *buf, size_t len);
+int format_control_stats(char *buf, size_t len);
+
+#endif /*__CONTROL_QUEUE_H__*/
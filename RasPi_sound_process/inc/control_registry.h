@@ -0,0 +1,60 @@
+#ifndef __CONTROL_REGISTRY_H__
+#define __CONTROL_REGISTRY_H__
+
+#include<stddef.h>
+#include"StandardDefs.h"
+#include"control_queue.h"
+
+/*
+ * Every tunable of the loaded graph, generated from its ControlInterface
+ * header by tools/control_registry.awk (Makefile: CONTROL_HEADER). Lookups
+ * by handle, "Module.param" or object ID go through hash tables built once
+ * by control_registry_init.
+ */
+typedef enum {
+    CONTROL_TYPE_INT,
+    CONTROL_TYPE_UINT,
+    CONTROL_TYPE_FLOAT,
+} Control_type_t;
+
+typedef struct {
+    const char *name;   //"ScalerN2.masterGain"
+    const char *module; //"ScalerN2"
+    UINT32 object_id;   //AWE_<module>_ID
+    UINT32 class_id;
+    UINT32 handle;
+    UINT32 mask;
+    UINT32 size;        //array size, 1 for scalars
+    Control_type_t type;
+    int has_range;      //from the "Range: min to max" comment
+    FLOAT32 min;
+    FLOAT32 max;
+    int primary;        //the module's first ranged parameter, "set <object ID> value" writes it
+} Control_object_t;
+
+extern const Control_object_t control_objects[]; //control_registry_table.c, generated
+extern const UINT32 control_object_count;
+
+int control_registry_init(void);
+const Control_object_t *control_find_handle(UINT32 handle);
+const Control_object_t *control_find_name(const char *name, size_t len);
+const Control_object_t *control_find_id(UINT32 object_id); //primary parameter
+
+/*
+ * First word of ref: "Module.param", "Module.param[i]", a handle or an object
+ * ID. index is -1 when none was given, rest points past the word.
+ */
+const Control_object_t *control_resolve(const char *ref, int *index, const char **rest);
+
+/*0 if word, as aweOS_ctrlSetValue takes it, is within obj's range*/
+int control_check_word(const Control_object_t *obj, INT32 word);
+/*Values text into w for obj at index, checked against type and range; an error line on failure*/
+int control_parse_values(const Control_object_t *obj, int index, const char *text, Control_write_t *w,
+                         char *err, size_t len);
+/*"name[offset] = v v v\n" from words read with aweOS_ctrlGetValue*/
+int control_format_values(const Control_object_t *obj, UINT32 offset, const INT32 *words, UINT32 count,
+                          char *buf, size_t len);
+/*One line per object: name, type[size], range, handle*/
+int format_control_list(char *buf, size_t len);
+
+#endif /*__CONTROL_REGISTRY_H__*/
@@ -0,0 +1,15 @@
+#ifndef __CONTROL_SERVER_H__
+#define __CONTROL_SERVER_H__
+
+/*
+ * Control socket: one epoll loop on the control thread serves every client.
+ * Sockets are non-blocking, each connection keeps its partial line and its
+ * unsent replies, so a slow or idle client never holds up another one.
+ */
+#define CONTROL_MAX_CLIENTS 32
+#define CONTROL_OUT_MAX (16 * TCP_REPLY_SIZE) //unsent replies before a client is dropped
+
+/*Serves server_fd until a fatal error, -1 then*/
+int control_server_run(int server_fd);
+
+#endif /*__CONTROL_SERVER_H__*/
@@ -0,0 +1,24 @@
+#ifndef __INTERLEAVE_H__
+#define __INTERLEAVE_H__
+
+#include"StandardDefs.h"
+
+/*
+ * Interleave/deinterleave kernels between frame-interleaved buffers and
+ * contiguous planar buffers ([channel][frames]). 2, 4 and 8 channels have
+ * SIMD versions (NEON on ARM, SSE2/AVX2 on x86); other channel counts and
+ * block tails go through the scalar loop. Buffers need no alignment.
+ */
+
+/*Pick kernels: NULL or "auto" = best the CPU supports, else "scalar", "sse2", "avx2", "neon"*/
+int interleave_init(const char *isa);
+
+/*ISA of the active 32-bit 2-channel kernel, e.g. for startup logging*/
+const char *interleave_isa(void);
+
+void deinterleave_s32(INT32 *planar, const INT32 *interleaved, UINT32 channels, UINT32 frames);
+void interleave_s32(INT32 *interleaved, const INT32 *planar, UINT32 channels, UINT32 frames);
+void deinterleave_s16(INT16 *planar, const INT16 *interleaved, UINT32 channels, UINT32 frames);
+void interleave_s16(INT16 *interleaved, const INT16 *planar, UINT32 channels, UINT32 frames);
+
+#endif /*__INTERLEAVE_H__*/
@@ -0,0 +1,36 @@
+#ifndef __LATENCY_HIST_H__
+#define __LATENCY_HIST_H__
+
+#include<stddef.h>
+#include<stdatomic.h>
+#include"StandardDefs.h"
+
+/*
+ * Lock-free log-bucket latency histogram. Values below 4 ns get their own
+ * bucket, above that every power of two is split into 4 sub-buckets, so a
+ * percentile is within 25% of the true value. Any thread may record, any
+ * thread may read; a reader racing with writers sees a slightly stale but
+ * consistent-enough snapshot.
+ */
+#define HIST_SUB_BITS 2
+#define HIST_BUCKETS (64 << HIST_SUB_BITS)
+
+typedef struct {
+    atomic_uint count[HIST_BUCKETS];
+    atomic_ullong total;
+    atomic_ullong sum_ns;
+    atomic_ullong max_ns;
+} Latency_hist_t;
+
+void hist_reset(Latency_hist_t *hist);
+void hist_record(Latency_hist_t *hist, UINT64 ns);
+/*Same for a histogram only one thread records into: plain stores, no locked RMW*/
+void hist_record_single(Latency_hist_t *hist, UINT64 ns);
+/*Upper bound of the bucket holding the p-th percentile (0..100), 0 when empty*/
+UINT64 hist_percentile(const Latency_hist_t *hist, double p);
+/*"n N p50 X p99 X p99.9 X max X us"*/
+int hist_format(const Latency_hist_t *hist, char *buf, size_t len);
+
+UINT64 hist_now_ns(void);
+
+#endif /*__LATENCY_HIST_H__*/
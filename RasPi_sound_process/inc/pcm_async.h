@@ -0,0 +1,32 @@
+#ifndef __PCM_ASYNC_H__
+#define __PCM_ASYNC_H__
+
+#include<stddef.h>
+#include<stdatomic.h>
+#include<sys/types.h>
+#include"latency_hist.h"
+
+/*
+ * Read-ahead engine behind the uring and pread source modes: keeps up to
+ * depth whole blocks of a regular file in flight, in file order, and hands
+ * them out in order. io_uring when the kernel and headers have it, else a
+ * shared pool of pread workers. Used through pcm_source only.
+ */
+typedef struct Pcm_async Pcm_async_t;
+
+/*
+ * NULL if fd isn't a regular file; falls back to the pool when io_uring
+ * can't be set up. Read latencies go to lat, waits for storage to stalls.
+ */
+Pcm_async_t *pcm_async_open(int fd, int want_uring, size_t block_bytes, UINT32 depth,
+                            UINT32 pool_threads, Latency_hist_t *lat, atomic_ulong *stalls);
+/*1 = io_uring, 0 = pread pool*/
+int pcm_async_is_uring(const Pcm_async_t *a);
+
+/*Copy the next block into dst: 1 = block, 0 = end of file, -1 = read error*/
+int pcm_async_next(Pcm_async_t *a, void *dst);
+
+/*Waits for reads still in flight*/
+void pcm_async_close(Pcm_async_t *a);
+
+#endif /*__PCM_ASYNC_H__*/
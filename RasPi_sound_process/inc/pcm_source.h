@@ -0,0 +1,58 @@
+#ifndef __PCM_SOURCE_H__
+#define __PCM_SOURCE_H__
+
+#include<stdio.h>
+#include<stddef.h>
+#include"StandardDefs.h"
+#include"latency_hist.h"
+#include"pcm_async.h"
+
+/*How a reader gets raw interleaved frames out of a .pcm file*/
+typedef enum {
+    SOURCE_IO_STDIO, //fread into a caller buffer
+    SOURCE_IO_MMAP,  //blocks are read straight out of a read-only mapping
+    SOURCE_IO_URING, //io_uring reads kept in flight ahead of the reader
+    SOURCE_IO_PREAD, //same, from a pool of pread worker threads
+} Source_io_t;
+
+#define SOURCE_ASYNC_DEPTH 4   //default blocks in flight for uring/pread
+#define SOURCE_ASYNC_THREADS 2 //default pread workers, shared by all sources
+
+typedef struct {
+    Source_io_t io;
+    size_t frame_bytes;
+    FILE *fp;
+    const unsigned char *map;
+    size_t map_len;
+    size_t pos;       //byte offset of the next block
+    size_t advised;   //mapping is MADV_WILLNEED up to here
+    size_t dropped;   //pages below here were released
+    size_t lag;       //bytes behind pos a zero-copy consumer may still be reading
+    size_t page;
+    Pcm_async_t *async;     //uring/pread read-ahead
+    Latency_hist_t read_lat; //per block: fread/prefault time, or submit to completion
+    atomic_ulong stalls;     //reader waited on an async read
+} Pcm_source_t;
+
+int pcm_source_parse_io(const char *name, Source_io_t *io);
+const char *pcm_source_io_name(Source_io_t io);
+
+/*Blocks in flight and pread workers for the async modes, before the first open*/
+void pcm_source_set_async(UINT32 depth, UINT32 threads);
+
+/*Falls back to stdio when the file can't be mapped or read asynchronously*/
+int pcm_source_open(Pcm_source_t *src, const char *path, Source_io_t io, size_t frame_bytes);
+
+/*
+ * Next block of frames interleaved samples. Points into the mapping in mmap
+ * mode (pages already faulted in), otherwise into scratch. NULL at end of
+ * file (partial blocks are dropped).
+ */
+const void *pcm_source_next(Pcm_source_t *src, void *scratch, UINT32 frames);
+
+/*Times the reader had to wait for the storage (async modes)*/
+unsigned long pcm_source_stalls(const Pcm_source_t *src);
+
+void pcm_source_close(Pcm_source_t *src);
+
+#endif /*__PCM_SOURCE_H__*/
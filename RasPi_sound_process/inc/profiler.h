@@ -0,0 +1,29 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include<stddef.h>
+#include"AWECoreOS.h"
+
+/*
+ * AWE profiling, sampled off the audio thread. Layout and module times come
+ * in profileSpeed ticks (24.8), they're reported as CPU cycles at coreSpeed,
+ * us and % of the block period.
+ */
+#define PROFILE_DEFAULT_MS 1000
+#define PROFILE_MAX_MODULES 32 //modules with a profileTime in the control registry
+
+typedef struct {
+    FLOAT32 core_speed;    //config.coreSpeed, Hz
+    FLOAT32 profile_speed; //config.profileSpeed, Hz
+    long long block_ns;
+} Profile_clock_t;
+
+/*Turns AWE profiling on and samples every period_ms on a control-role thread*/
+int profiler_start(AWEOSInstance *instance, const Profile_clock_t *clock, UINT32 period_ms);
+void profiler_stop(void);
+int profiler_running(void);
+
+/*Layout 0 and every module: last, peak, in cycles, us and % CPU*/
+int format_profile(char *buf, size_t len);
+
+#endif /*__PROFILER_H__*/
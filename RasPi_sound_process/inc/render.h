@@ -0,0 +1,19 @@
+#ifndef __RENDER_H__
+#define __RENDER_H__
+
+#include<stdio.h>
+#include"StandardDefs.h"
+
+/*Offline output: a .wav through the AWE wav helpers, anything else raw S32_LE interleaved*/
+typedef struct {
+    FILE *fp;
+    int wav;
+    UINT32 channels;
+    UINT64 frames;
+} Render_file_t;
+
+int render_open(Render_file_t *r, const char *path, UINT32 channels, UINT32 sample_rate);
+int render_write(Render_file_t *r, const INT32 *interleaved, UINT32 frames);
+void render_close(Render_file_t *r);
+
+#endif /*__RENDER_H__*/
@@ -0,0 +1,53 @@
+#ifndef __RT_SCHED_H__
+#define __RT_SCHED_H__
+
+#include<sched.h> //cpu_set_t, needs -D_GNU_SOURCE
+#include<stddef.h>
+#include"AWECoreOS.h"
+
+/*Stack touched by every thread entering a role when memory is locked*/
+#define RT_STACK_PREFAULT (256 * 1024)
+
+/*Threads the application runs, each gets its own policy and CPU mask*/
+typedef enum {
+    RT_ROLE_PROCESS, //sound_processing, the AWE audio callback
+    RT_ROLE_READER,  //read_thread per source
+    RT_ROLE_CONTROL, //main thread: TCP accept/chat, plus the AWE tuning socket thread
+    RT_ROLE_PUMP,    //AWE pump threads and work thread, priorities set by AWE
+    RT_ROLE_COUNT
+} Rt_role_t;
+
+typedef struct {
+    int policy;     //SCHED_OTHER, SCHED_FIFO or SCHED_RR
+    int priority;   //1..99 for FIFO/RR
+    cpu_set_t cpus;
+    int pinned;     //cpus is set
+} Rt_role_cfg_t;
+
+typedef struct {
+    Rt_role_cfg_t role[RT_ROLE_COUNT];
+    int lock_memory; //mlockall and prefault stacks/buffers
+} Rt_config_t;
+
+extern Rt_config_t rt_cfg;
+
+/*"other", "fifo", "rr"*/
+int rt_parse_policy(const char *name, int *policy);
+/*"role=list", list like "2,3" or "0-1,3"; role is process, reader, control or pump*/
+int rt_parse_affinity(const char *spec);
+const char *rt_role_name(Rt_role_t role);
+
+/*Print what each role is configured to*/
+void rt_log_config(void);
+
+/*mlockall (current and future) if configured; call before the input files are mapped*/
+int rt_lock_memory(void);
+/*Write-touch a buffer so it is backed and locked before the audio path uses it*/
+void rt_prefault(void *buf, size_t bytes);
+
+/*Apply a role's policy/affinity to the calling thread, prefault its stack*/
+int rt_enter(Rt_role_t role);
+/*Pin the threads AWE created; call after the first aweOS_audioPumpAll*/
+int rt_pin_awe_threads(AWEOSInstance *instance);
+
+#endif /*__RT_SCHED_H__*/
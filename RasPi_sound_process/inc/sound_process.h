@@ -14,51 +14,122 @@
 #include"AWECoreOS.h"
 #include"ModuleList.h"
 #include"Kanavi_passthrouh_test_ControlInterface.h"
+#include"block_ring.h"
+#include"pcm_source.h"
+#include"interleave.h"
+#include"rt_sched.h"
+#include"audio_sink.h"
+#include"stage_timing.h"
+#include"xrun.h"
+#include"control_queue.h"
+#include"control_registry.h"
+#include"control_binary.h"
+#include"control_server.h"
+#include"profiler.h"
 
-/*AWE process*/
-#define AWE_IN_CHANNELS 4
-#define AWE_OUT_CHANNELS 2
-#define AWE_BLOCK_SIZE 768
-#define AWE_SAMPLE_RATE 48000
+/*AWE process, the instance starts with these and is re-created to match the graph*/
+#define AWE_DEFAULT_IN_CHANNELS 4
+#define AWE_DEFAULT_OUT_CHANNELS 2
+#define AWE_DEFAULT_BLOCK_SIZE 768
+#define AWE_DEFAULT_SAMPLE_RATE 48000
+#define AWE_DEFAULT_THREADS 4 //config.numThreads, sublayouts AWE may run
 #define AWE_SAMPLE_TYPE Sample32bit
 #define AWE_PORT_NO 15002
 
+/*Input sources*/
+#define SOURCE_CHANNELS 2 //default channels per .pcm
+#define SOURCE_MAX 64      //sources are tracked in a 64-bit mask
+#define RING_DEPTH 4 //default blocks queued per source
+
 /*TCP Socket*/
 #define TCP_PORT_NO 24
-#define TCP_BUFF_SIZE 64
-
-/*Mutex, cond*/
-extern pthread_mutex_t mutex;
-extern pthread_cond_t cond_reader;
-extern pthread_cond_t cond_main;
+#define TCP_BUFF_SIZE 8192  //per-connection input, longest control line or binary frame
+#define TCP_REPLY_SIZE 4096
 
 /*AWE init*/
-AWEOSInstance *awe;
+extern AWEOSInstance *awe;
 extern const void* moduleDescriptorTable[];
 extern UINT32 moduleDescriptorTableSize;
 
-//Buffer
-INT32 input_channels[AWE_IN_CHANNELS][AWE_BLOCK_SIZE];
-INT32 output_channels[AWE_BLOCK_SIZE * AWE_OUT_CHANNELS];
-int ready_channels[AWE_IN_CHANNELS];
+/*Geometry of the loaded layout, all buffers are sized from it*/
+typedef struct {
+    UINT32 in_channels;
+    UINT32 out_channels;
+    UINT32 block_size;
+    UINT32 sample_rate;
+    long long block_ns;
+    FLOAT32 core_speed;    //config.coreSpeed, for profiling
+    FLOAT32 profile_speed; //config.profileSpeed
+} Awe_geometry_t;
+
+extern Awe_geometry_t geom;
+
+//Buffer, allocated by init_buffers
+extern Block_ring_t *source_rings; //[num_sources], Source_block_t slots, by init_sources
+extern INT32 *output_channels;     //[block_size * out_channels]
 
-/*Device, file defination*/
+/*How source blocks are kept between read_thread and sound_processing*/
+typedef enum {
+    LAYOUT_PLANAR,      //deinterleaved per channel, imported/exported with stride 1
+    LAYOUT_INTERLEAVED, //kept as read, imported with stride = source channels
+} Block_layout_t;
+
+/*Pipeline configuration, set from the command line*/
 typedef struct {
-    snd_pcm_t *dev;
-} PCM_device_t;
+    UINT32 queue_depth;    //blocks per source ring, RING_MIN_DEPTH..RING_MAX_DEPTH
+    UINT32 high_watermark; //reader pauses and playback starts at this fill, 0 = depth
+    UINT32 low_watermark;  //reader resumes at this fill, 0 = depth / 2
+    Source_io_t input_io;  //how read_thread pulls frames from the .pcm files
+    Block_layout_t layout;
+    Sink_type_t sink;
+    const char *sink_path; //file sink
+    Pcm_profile_t pcm_profile; //ALSA and clocked null sink
+    UINT32 period_frames;  //a multiple or divisor of the block size, 0 = profile default
+    UINT32 periods;        //periods per buffer, 0 = profile default
+    Xrun_policy_t xrun_policy; //clocked sinks, after an underrun
+    UINT32 awe_threads;    //config.numThreads
+    int exit_at_end;       //also exit with a clocked sink once the sources ended
+    const char *report_path; //append a run summary, .csv or else JSON lines
+    UINT32 profile_ms;     //sample AWE profiling this often, 0 = off
+} Pipeline_config_t;
+
+extern Pipeline_config_t pipeline_cfg;
 
+/*File defination*/
 typedef struct {
     const char *file;
-    int channel_offset; //0 or 2
+    UINT32 channels;       //interleaved channels in the file
+    UINT32 channel_offset; //first AWE input it feeds
+    Block_ring_t *ring;
+    Pcm_source_t src;
+    INT32 *scratch;     //one interleaved block, stdio reads in planar layout
 } Read_file_t;
 
+/*
+ * One ring slot. samples is what sound_processing imports: data holding
+ * [channels][block_size] in planar layout, or an interleaved block
+ * that is either data or, with mmap input, the file mapping itself (zero-copy,
+ * data is then not allocated).
+ */
+typedef struct {
+    const INT32 *samples;
+    INT32 data[];
+} Source_block_t;
+
+extern Read_file_t *sources;
+extern UINT32 num_sources;
+
 /*Function*/
-int init_pcm(PCM_device_t *device);
 int init_aweCoreOS(const char* file);
 int init_TCPSocket(int *server_fd);
+int init_buffers(void);
+int parse_source(const char *arg, Read_file_t *rd);
+int init_sources(Read_file_t *readers, UINT32 count);
 void *read_thread(void *arg);
+void export_block(INT32 *dst); //pumped output, interleaved, for the sinks
 void *sound_processing(void *arg);
-void socket_chat(int client_fd);
+int control_command(const char *line, char *reply, size_t len, Control_done_t done, void *user);
+int format_ring_stats(char *buf, size_t len);
 
 #endif /*__SOUND_PROCESS_H__*/
 
@@ -0,0 +1,79 @@
+#ifndef __STAGE_TIMING_H__
+#define __STAGE_TIMING_H__
+
+#include<stddef.h>
+#include<time.h>
+#include"StandardDefs.h"
+#include"latency_hist.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include<x86intrin.h>
+#endif
+
+/*
+ * Per-block timing of sound_processing. Only the processing thread records,
+ * into single-writer histograms, so any thread can read them live. Ticks
+ * are the cycle counter (TSC, CNTVCT) where there is one, a block costs a
+ * handful of counter reads and histogram stores.
+ */
+typedef enum {
+    STAGE_WAIT,   //until every source has a block
+    STAGE_IMPORT, //aweOS_audioImportSamples
+    STAGE_PUMP,   //aweOS_audioPumpAll
+    STAGE_EXPORT, //aweOS_audioExportSamples and interleave
+    STAGE_SINK,   //sink write minus export: snd_pcm_writei, device or file wait
+    STAGE_COUNT
+} Stage_t;
+
+/*Import + pump + export, the CPU one block costs; load = busy / block period*/
+extern Latency_hist_t stage_hist[STAGE_COUNT];
+extern Latency_hist_t busy_hist;
+extern atomic_ulong deadline_misses;
+
+static inline UINT64 stage_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    UINT64 t;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UINT64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/*Calibrates the tick rate, before the processing thread starts*/
+void stage_init(UINT64 block_ns);
+UINT64 stage_ticks_to_ns(UINT64 ticks);
+const char *stage_name(Stage_t stage);
+
+/*Times of one block, filled in by the processing thread*/
+typedef struct {
+    UINT64 start;
+    UINT64 end[STAGE_COUNT]; //end of wait, import, pump and sink, export is timed on its own
+    UINT64 export_ticks;     //export happens inside the sink write
+} Stage_block_t;
+
+extern Stage_block_t stage_block;
+
+/*Blocks run back to back, a block starts where the last one's sink write ended*/
+static inline void stage_begin(void) {
+    stage_block.start = stage_block.end[STAGE_SINK] ? stage_block.end[STAGE_SINK] : stage_ticks();
+    stage_block.export_ticks = 0;
+}
+
+static inline void stage_mark(Stage_t stage) {
+    stage_block.end[stage] = stage_ticks();
+}
+
+static inline void stage_export_done(UINT64 since) {
+    stage_block.export_ticks += stage_ticks() - since;
+}
+
+void stage_commit(void);
+
+/*One line per stage plus "load avg X% p99 X% max X%, deadline missed N"*/
+int format_stage_stats(char *buf, size_t len);
+
+#endif /*__STAGE_TIMING_H__*/
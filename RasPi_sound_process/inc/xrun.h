@@ -0,0 +1,64 @@
+#ifndef __XRUN_H__
+#define __XRUN_H__
+
+#include<stddef.h>
+#include<time.h>
+#include"StandardDefs.h"
+#include"stage_timing.h"
+
+/*
+ * Underruns of the clocked sinks. The audio thread logs each one with the
+ * stage times of the block that missed into a small ring and never blocks,
+ * a notifier thread hands the events to the registered callbacks.
+ */
+#define XRUN_LOG 16          //events kept for "xruns"
+#define XRUN_MAX_CALLBACKS 4
+#define XRUN_MAX_PERIODS 16  //grow stops here and falls back to restart
+
+/*What the sink does after an underrun*/
+typedef enum {
+    XRUN_RESTART, //prepare and refill to the start threshold with real audio
+    XRUN_PREFILL, //prepare, queue silence up to the start threshold, resume at once
+    XRUN_GROW,    //add a period to the buffer, then restart
+} Xrun_policy_t;
+
+typedef enum {
+    XRUN_EVENT_ERROR,    //the sink could not recover
+    XRUN_EVENT_UNDERRUN,
+} Xrun_kind_t;
+
+/*Callback mask, bits as in aweOS_audioRecordingRegisterNotificationCallback*/
+#define XRUN_NOTIFY_ERRORS (1 << XRUN_EVENT_ERROR)
+#define XRUN_NOTIFY_XRUNS  (1 << XRUN_EVENT_UNDERRUN)
+#define XRUN_NOTIFY_ALL    (XRUN_NOTIFY_XRUNS | XRUN_NOTIFY_ERRORS)
+
+typedef struct {
+    Xrun_kind_t kind;
+    unsigned long count;          //underruns so far, this one included
+    UINT64 block;                 //blocks written before it
+    struct timespec wall;         //CLOCK_REALTIME
+    UINT64 stage_ns[STAGE_COUNT]; //the block that missed, sink includes the recovery
+    int error;                    //negative errno from the sink
+    UINT32 buffer_frames;         //after recovery
+    UINT32 prefill_frames;        //silence queued by the recovery
+} Xrun_event_t;
+
+typedef void (*Xrun_callback_t)(const Xrun_event_t *event, void *user);
+
+int xrun_parse_policy(const char *name, Xrun_policy_t *policy);
+const char *xrun_policy_name(Xrun_policy_t policy);
+
+/*Callbacks run on the notifier thread, not the audio thread*/
+int xrun_register_callback(Xrun_callback_t callback, void *user, UINT32 mask);
+void xrun_log_callback(const Xrun_event_t *event, void *user); //one line on stderr
+int xrun_start(void);
+void xrun_stop(void);
+
+/*Audio thread only, once the sink has recovered from the underrun or given up*/
+void xrun_report(Xrun_kind_t kind, int error, UINT64 block, UINT32 buffer_frames, UINT32 prefill_frames);
+unsigned long xrun_count(void);
+
+/*Count and policy, with_events adds the last XRUN_LOG events and their stage times*/
+int format_xrun_stats(char *buf, size_t len, int with_events);
+
+#endif /*__XRUN_H__*/
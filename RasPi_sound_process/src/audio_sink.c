@@ -0,0 +1,229 @@
+#include<time.h>
+#include"../inc/sound_process.h"
+
+static const char *sink_names[] = {
+    [SINK_ALSA]         = "alsa",
+    [SINK_ALSA_MMAP]    = "alsa-mmap",
+    [SINK_FILE]         = "file",
+    [SINK_NULL]         = "null",
+    [SINK_NULL_CLOCKED] = "null-clocked",
+};
+
+/*Period = block / period_div, start threshold 0 = full buffer*/
+static const struct {
+    const char *name;
+    unsigned int period_div;
+    unsigned int periods;
+    unsigned int start_blocks;
+} pcm_profiles[] = {
+    [PCM_PROFILE_SAFE]        = { "safe",        1, 4, 0 },
+    [PCM_PROFILE_BALANCED]    = { "balanced",    1, 3, 2 },
+    [PCM_PROFILE_LOW_LATENCY] = { "low-latency", 2, 4, 1 },
+};
+
+int pcm_parse_profile(const char *name, Pcm_profile_t *profile) {
+    for(size_t i = 0; i < sizeof(pcm_profiles) / sizeof(pcm_profiles[0]); i++) {
+        if(strcmp(name, pcm_profiles[i].name) == 0) {
+            *profile = (Pcm_profile_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *pcm_profile_name(Pcm_profile_t profile) {
+    return pcm_profiles[profile].name;
+}
+
+int sink_block_aligned(unsigned long frames) {
+    return frames > 0 && (frames % geom.block_size == 0 || geom.block_size % frames == 0);
+}
+
+int sink_buffer_geometry(UINT32 *period, UINT32 *periods, UINT32 *start) {
+    const Pcm_profile_t profile = pipeline_cfg.pcm_profile;
+    *period = pipeline_cfg.period_frames ? pipeline_cfg.period_frames
+                                         : geom.block_size / pcm_profiles[profile].period_div;
+    *periods = pipeline_cfg.periods ? pipeline_cfg.periods : pcm_profiles[profile].periods;
+    *start = pcm_profiles[profile].start_blocks * geom.block_size;
+    if(!sink_block_aligned(*period) || *periods < 2) {
+        fprintf(stderr, "period must be a multiple or divisor of %u frames, periods >= 2\n", geom.block_size);
+        return -1;
+    }
+    return 0;
+}
+
+int sink_parse(const char *spec, Sink_type_t *type, const char **path) {
+    if(strncmp(spec, "file:", 5) == 0 && spec[5]) {
+        *type = SINK_FILE;
+        *path = spec + 5;
+        return 0;
+    }
+    for(size_t i = 0; i < sizeof(sink_names) / sizeof(sink_names[0]); i++) {
+        if(i != SINK_FILE && strcmp(spec, sink_names[i]) == 0) {
+            *type = (Sink_type_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *sink_name(Sink_type_t type) {
+    return sink_names[type];
+}
+
+/*File*/
+static int file_open(Audio_sink_t *sink) {
+    if(render_open(&sink->file, sink->path, geom.out_channels, geom.sample_rate) != 0) {
+        return -1;
+    }
+    printf("Rendering to %s (%s)\n", sink->path, sink->file.wav ? "wav" : "raw S32_LE");
+    return 0;
+}
+
+static int file_write(Audio_sink_t *sink) {
+    export_block(output_channels);
+    return render_write(&sink->file, output_channels, geom.block_size);
+}
+
+static void file_close(Audio_sink_t *sink) {
+    render_close(&sink->file);
+}
+
+/*Null, optionally clocked like a device with the profile's buffer*/
+static int null_open(Audio_sink_t *sink) {
+    Sink_clock_t *clock = &sink->clock;
+    UINT32 period, periods, start;
+    if(sink->type != SINK_NULL_CLOCKED) {
+        printf("Null sink, unclocked\n");
+        return 0;
+    }
+    if(sink_buffer_geometry(&period, &periods, &start) != 0) {
+        return -1;
+    }
+    clock->period_frames = period;
+    clock->buffer_frames = period * periods;
+    if(clock->buffer_frames < geom.block_size) {
+        clock->buffer_frames = geom.block_size;
+    }
+    clock->start_frames = start == 0 || start > clock->buffer_frames ? clock->buffer_frames : start;
+    printf("Null sink, clocked, profile %s: buffer %.2f ms, start %.2f ms, xrun %s\n",
+           pcm_profile_name(pipeline_cfg.pcm_profile),
+           1000.0 * clock->buffer_frames / geom.sample_rate,
+           1000.0 * clock->start_frames / geom.sample_rate,
+           xrun_policy_name(pipeline_cfg.xrun_policy));
+    return 0;
+}
+
+static UINT64 clock_played(const Sink_clock_t *clock, UINT64 now) {
+    return (now - clock->start_ns) * geom.sample_rate / 1000000000ULL;
+}
+
+static void sleep_until(UINT64 ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+/*Ran dry: like ALSA, stop, then recover as pipeline_cfg.xrun_policy says*/
+static void null_xrun(Audio_sink_t *sink) {
+    Sink_clock_t *clock = &sink->clock;
+    UINT32 prefill = 0;
+    clock->running = 0;
+    clock->written = 0;
+    switch(pipeline_cfg.xrun_policy) {
+    case XRUN_GROW:
+        if(clock->buffer_frames / clock->period_frames < XRUN_MAX_PERIODS) {
+            if(clock->start_frames == clock->buffer_frames) {
+                clock->start_frames += clock->period_frames;
+            }
+            clock->buffer_frames += clock->period_frames;
+        }
+        break;
+    case XRUN_PREFILL:
+        if(clock->start_frames > geom.block_size) {
+            prefill = clock->start_frames - geom.block_size;
+            clock->written = prefill;
+        }
+        break;
+    default:
+        break;
+    }
+    xrun_report(XRUN_EVENT_UNDERRUN, -EPIPE, sink->frames / geom.block_size, clock->buffer_frames, prefill);
+}
+
+static int null_write(Audio_sink_t *sink) {
+    Sink_clock_t *clock = &sink->clock;
+    /*Still export, the copy is part of what we measure*/
+    export_block(output_channels);
+    if(sink->type != SINK_NULL_CLOCKED) {
+        return 0;
+    }
+    UINT64 now = hist_now_ns();
+    if(clock->running && clock_played(clock, now) > clock->written) {
+        null_xrun(sink);
+    }
+    if(clock->running && clock->written + geom.block_size > clock_played(clock, now) + clock->buffer_frames) {
+        /*Block until the simulated device has room for the whole block*/
+        UINT64 need = clock->written + geom.block_size - clock->buffer_frames;
+        sleep_until(clock->start_ns + (need * 1000000000ULL + geom.sample_rate - 1) / geom.sample_rate);
+    }
+    clock->written += geom.block_size;
+    if(!clock->running && clock->written >= clock->start_frames) {
+        clock->running = 1;
+        clock->start_ns = hist_now_ns();
+    }
+    return 0;
+}
+
+static void null_drain(Audio_sink_t *sink) {
+    Sink_clock_t *clock = &sink->clock;
+    if(sink->type == SINK_NULL_CLOCKED) {
+        if(!clock->running && clock->written) {
+            clock->running = 1;
+            clock->start_ns = hist_now_ns();
+        }
+        if(clock->running) {
+            UINT64 end = clock->start_ns + clock->written * 1000000000ULL / geom.sample_rate;
+            if(end > hist_now_ns()) {
+                sleep_until(end);
+            }
+        }
+        printf("Null sink: %lu xruns\n", xrun_count());
+    }
+}
+
+static const Audio_sink_ops_t sink_file_ops = { file_open, file_write, NULL, file_close };
+static const Audio_sink_ops_t sink_null_ops = { null_open, null_write, null_drain, NULL };
+
+int sink_open(Audio_sink_t *sink, Sink_type_t type, const char *path) {
+    memset(sink, 0, sizeof(*sink));
+    sink->type = type;
+    sink->path = path;
+    switch(type) {
+    case SINK_ALSA:
+    case SINK_ALSA_MMAP: sink->ops = &sink_alsa_ops; break;
+    case SINK_FILE:      sink->ops = &sink_file_ops; break;
+    default:             sink->ops = &sink_null_ops; break;
+    }
+    return sink->ops->open(sink);
+}
+
+int sink_write(Audio_sink_t *sink) {
+    if(sink->ops->write(sink) != 0) {
+        return -1;
+    }
+    sink->frames += geom.block_size;
+    return 0;
+}
+
+void sink_drain(Audio_sink_t *sink) {
+    if(sink->ops->drain) {
+        sink->ops->drain(sink);
+    }
+}
+
+void sink_close(Audio_sink_t *sink) {
+    if(sink->ops && sink->ops->close) {
+        sink->ops->close(sink);
+    }
+}
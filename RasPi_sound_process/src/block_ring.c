@@ -0,0 +1,172 @@
+#include<stdlib.h>
+#include<string.h>
+#include<sched.h>
+#include<time.h>
+#include"../inc/block_ring.h"
+
+#define RING_SPIN_LIMIT  64
+#define RING_YIELD_LIMIT 96
+
+static inline void cpu_relax(void) {
+#if defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+    __asm__ __volatile__("pause" ::: "memory");
+#else
+    atomic_signal_fence(memory_order_seq_cst);
+#endif
+}
+
+int ring_init(Block_ring_t *ring, UINT32 depth, UINT32 high, UINT32 low, size_t block_bytes) {
+    memset(ring, 0, sizeof(*ring));
+    if(high == 0) {
+        high = depth;
+    }
+    if(low == 0) {
+        low = depth / 2;
+    }
+    if(depth < RING_MIN_DEPTH || depth > RING_MAX_DEPTH || high > depth || low >= high || block_bytes == 0) {
+        return -1;
+    }
+    /*Keep every slot on its own cache lines*/
+    block_bytes = (block_bytes + RING_CACHE_LINE - 1) & ~(size_t)(RING_CACHE_LINE - 1);
+    if(posix_memalign((void **)&ring->data, RING_CACHE_LINE, block_bytes * depth) != 0) {
+        ring->data = NULL;
+        return -1;
+    }
+    memset(ring->data, 0, block_bytes * depth);
+    ring->depth = depth;
+    ring->high = high;
+    ring->low = low;
+    ring->block_bytes = block_bytes;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->closed, 0);
+    atomic_init(&ring->full_waits, 0);
+    atomic_init(&ring->max_fill, 0);
+    atomic_init(&ring->underruns, 0);
+    atomic_init(&ring->low_water_hits, 0);
+    atomic_init(&ring->min_fill, depth);
+    return 0;
+}
+
+void ring_free(Block_ring_t *ring) {
+    free(ring->data);
+    ring->data = NULL;
+}
+
+void *ring_write_begin(Block_ring_t *ring) {
+    UINT32 head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if(head - ring->tail_cache >= ring->depth) {
+        ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if(head - ring->tail_cache >= ring->depth) {
+            return NULL;
+        }
+    }
+    return ring->data + (size_t)(head % ring->depth) * ring->block_bytes;
+}
+
+void *ring_write_wait(Block_ring_t *ring, long sleep_ns) {
+    unsigned spins = 0;
+    void *slot;
+    if(ring->paused) {
+        /*Hysteresis: refill only once the consumer has dropped to low*/
+        while(ring_fill(ring) > ring->low) {
+            ring_backoff(&spins, sleep_ns);
+        }
+        ring->paused = 0;
+    }
+    while((slot = ring_write_begin(ring)) == NULL) {
+        if(spins == 0) {
+            atomic_fetch_add_explicit(&ring->full_waits, 1, memory_order_relaxed);
+        }
+        ring_backoff(&spins, sleep_ns);
+    }
+    return slot;
+}
+
+void ring_write_commit(Block_ring_t *ring) {
+    UINT32 head = atomic_load_explicit(&ring->head, memory_order_relaxed) + 1;
+    atomic_store_explicit(&ring->head, head, memory_order_release);
+    ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    UINT32 fill = head - ring->tail_cache;
+    ring->paused = fill >= ring->high;
+    if(fill > atomic_load_explicit(&ring->max_fill, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->max_fill, fill, memory_order_relaxed);
+    }
+}
+
+void ring_close(Block_ring_t *ring) {
+    atomic_store_explicit(&ring->closed, 1, memory_order_release);
+}
+
+void *ring_read_begin(Block_ring_t *ring) {
+    UINT32 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if(tail == ring->head_cache) {
+        ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if(tail == ring->head_cache) {
+            return NULL;
+        }
+    }
+    return ring->data + (size_t)(tail % ring->depth) * ring->block_bytes;
+}
+
+void ring_read_release(Block_ring_t *ring) {
+    UINT32 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+void ring_account_read(Block_ring_t *ring) {
+    UINT32 fill = ring_fill(ring);
+    if(fill == 0 && !atomic_load_explicit(&ring->closed, memory_order_acquire)) {
+        atomic_fetch_add_explicit(&ring->underruns, 1, memory_order_relaxed);
+    }
+    if(fill < ring->low) {
+        atomic_fetch_add_explicit(&ring->low_water_hits, 1, memory_order_relaxed);
+    }
+    if(fill < atomic_load_explicit(&ring->min_fill, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->min_fill, fill, memory_order_relaxed);
+    }
+}
+
+int ring_is_primed(Block_ring_t *ring) {
+    return ring_fill(ring) >= ring->high || atomic_load_explicit(&ring->closed, memory_order_acquire);
+}
+
+int ring_is_drained(Block_ring_t *ring) {
+    /*closed must be observed before head, so a final commit is not missed*/
+    if(!atomic_load_explicit(&ring->closed, memory_order_acquire)) {
+        return 0;
+    }
+    return atomic_load_explicit(&ring->head, memory_order_acquire) ==
+           atomic_load_explicit(&ring->tail, memory_order_relaxed);
+}
+
+UINT32 ring_fill(Block_ring_t *ring) {
+    UINT32 tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    UINT32 head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return head - tail;
+}
+
+void ring_get_stats(Block_ring_t *ring, Ring_stats_t *stats) {
+    stats->depth = ring->depth;
+    stats->fill = ring_fill(ring);
+    stats->min_fill = atomic_load_explicit(&ring->min_fill, memory_order_relaxed);
+    stats->max_fill = atomic_load_explicit(&ring->max_fill, memory_order_relaxed);
+    stats->underruns = atomic_load_explicit(&ring->underruns, memory_order_relaxed);
+    stats->low_water_hits = atomic_load_explicit(&ring->low_water_hits, memory_order_relaxed);
+    stats->full_waits = atomic_load_explicit(&ring->full_waits, memory_order_relaxed);
+    stats->blocks = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+}
+
+void ring_backoff(unsigned *spins, long sleep_ns) {
+    unsigned n = (*spins)++;
+    if(n < RING_SPIN_LIMIT) {
+        cpu_relax();
+    } else if(n < RING_YIELD_LIMIT) {
+        sched_yield();
+    } else {
+        struct timespec ts = { sleep_ns / 1000000000L, sleep_ns % 1000000000L };
+        nanosleep(&ts, NULL);
+    }
+}
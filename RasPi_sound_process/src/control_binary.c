@@ -0,0 +1,245 @@
+#include"../inc/sound_process.h"
+
+#define OP_HEADER 12 //op, flags, count, handle, offset
+#define REPLY_HEADER (CONTROL_FRAME_HEADER + 16)
+#define REPLY_OP 8
+
+typedef struct {
+    UINT8 op;
+    UINT8 flags;
+    UINT16 count;
+    UINT32 handle;
+    UINT32 offset;
+    UINT32 mask;
+    INT32 status;      //reply
+    UINT16 reply_flags;
+} Frame_op_t;
+
+/*A frame waiting for the acks of its sets, freed once it has replied*/
+typedef struct {
+    Control_frame_done_t done;
+    void *user;
+    UINT32 writes;       //its sets, in queue order
+    UINT32 acked;
+    UINT64 block;
+    UINT16 write_op[CONTROL_BATCH_MAX]; //op of each write
+    UINT32 op_count;
+    Frame_op_t op[];
+} Frame_ctx_t;
+
+static unsigned long count_frames, count_ops, count_rejected;
+
+static UINT32 rd16(const UINT8 *p) {
+    return p[0] | p[1] << 8;
+}
+
+static UINT32 rd32(const UINT8 *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (UINT32)p[3] << 24;
+}
+
+static UINT8 *wr16(UINT8 *p, UINT32 v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    return p + 2;
+}
+
+static UINT8 *wr32(UINT8 *p, UINT32 v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+    return p + 4;
+}
+
+static UINT8 *wr_header(UINT8 *p, UINT32 op_count, UINT32 payload_len) {
+    *p++ = CONTROL_FRAME_MAGIC;
+    *p++ = CONTROL_FRAME_VERSION;
+    p = wr16(p, op_count);
+    return wr32(p, payload_len);
+}
+
+long control_frame_size(const UINT8 *buf, size_t len) {
+    if(len < CONTROL_FRAME_HEADER) {
+        return 0;
+    }
+    if(buf[0] != CONTROL_FRAME_MAGIC) {
+        return -1;
+    }
+    UINT32 payload = rd32(buf + 4);
+    if(payload > CONTROL_FRAME_MAX - CONTROL_FRAME_HEADER) {
+        return -1;
+    }
+    return CONTROL_FRAME_HEADER + payload;
+}
+
+int control_frame_error(INT32 status, UINT8 *reply, size_t reply_len) {
+    if(reply_len < REPLY_HEADER) {
+        return 0;
+    }
+    UINT8 *p = wr_header(reply, 0, REPLY_HEADER - CONTROL_FRAME_HEADER);
+    p = wr32(p, status);
+    memset(p, 0, 12);
+    count_rejected++;
+    return REPLY_HEADER;
+}
+
+/*
+ * Checks the ops and fills ctx->op, sets go into writes split at
+ * CONTROL_MAX_WORDS. E_SUCCESS or why the frame is refused.
+ */
+static INT32 parse_ops(const UINT8 *p, const UINT8 *end, Frame_ctx_t *ctx, Control_write_t *writes,
+                       size_t *reply_size) {
+    size_t size = REPLY_HEADER + (size_t)ctx->op_count * REPLY_OP;
+    for(UINT32 i = 0; i < ctx->op_count; i++) {
+        Frame_op_t *op = &ctx->op[i];
+        if(end - p < OP_HEADER) {
+            return E_BADPACKET;
+        }
+        op->op = p[0];
+        op->flags = p[1];
+        op->count = rd16(p + 2);
+        op->handle = rd32(p + 4);
+        op->offset = rd32(p + 8);
+        p += OP_HEADER;
+        if((op->op != CONTROL_OP_GET && op->op != CONTROL_OP_SET) || (op->flags & ~CONTROL_OP_MASKED)) {
+            return E_ARGUMENT_ERROR;
+        }
+        if(op->flags & CONTROL_OP_MASKED) {
+            if(end - p < 4) {
+                return E_BADPACKET;
+            }
+            op->mask = rd32(p);
+            p += 4;
+        }
+        const Control_object_t *obj = control_find_handle(op->handle);
+        if(!obj) {
+            return E_OBJECT_ID_NOT_FOUND;
+        }
+        if(op->count == 0 || (UINT64)op->offset + op->count > obj->size) {
+            return E_BAD_MEMBER_INDEX;
+        }
+        if(op->op == CONTROL_OP_GET) {
+            size += (size_t)op->count * 4;
+            continue;
+        }
+        if(end - p < (long)op->count * 4) {
+            return E_BADPACKET;
+        }
+        for(UINT32 done = 0; done < op->count; done += CONTROL_MAX_WORDS) {
+            if(ctx->writes == CONTROL_BATCH_MAX) {
+                return E_MESSAGE_LENGTH_TOO_LONG;
+            }
+            Control_write_t *w = &writes[ctx->writes];
+            w->handle = op->handle;
+            w->offset = op->offset + done;
+            w->count = op->count - done < CONTROL_MAX_WORDS ? op->count - done : CONTROL_MAX_WORDS;
+            w->mask = op->mask;
+            w->masked = op->flags & CONTROL_OP_MASKED;
+            for(UINT32 j = 0; j < w->count; j++, p += 4) {
+                w->value[j] = (INT32)rd32(p);
+                if(control_check_word(obj, w->value[j]) != 0) {
+                    return E_PARAMETER_ERROR;
+                }
+            }
+            ctx->write_op[ctx->writes++] = i;
+        }
+    }
+    if(p != end) {
+        return E_BADPACKET;
+    }
+    *reply_size = size;
+    return E_SUCCESS;
+}
+
+/*Set results are in, read the gets and write the whole reply*/
+static int frame_reply(Frame_ctx_t *ctx, UINT8 *reply) {
+    UINT8 *p = wr_header(reply, ctx->op_count, 0);
+    p = wr32(p, E_SUCCESS);
+    p = wr32(p, 0);
+    p = wr32(wr32(p, (UINT32)ctx->block), (UINT32)(ctx->block >> 32));
+    for(UINT32 i = 0; i < ctx->op_count; i++) {
+        Frame_op_t *op = &ctx->op[i];
+        UINT8 *op_reply = p;
+        p += REPLY_OP;
+        if(op->op == CONTROL_OP_GET) {
+            INT32 words[CONTROL_MAX_WORDS];
+            for(UINT32 done = 0; done < op->count && op->status == E_SUCCESS; done += CONTROL_MAX_WORDS) {
+                UINT32 n = op->count - done < CONTROL_MAX_WORDS ? op->count - done : CONTROL_MAX_WORDS;
+                op->status = op->flags & CONTROL_OP_MASKED
+                                 ? aweOS_ctrlGetValueMask(awe, op->handle, words, op->offset + done, n, op->mask)
+                                 : aweOS_ctrlGetValue(awe, op->handle, words, op->offset + done, n);
+                for(UINT32 j = 0; j < n && op->status == E_SUCCESS; j++) {
+                    p = wr32(p, words[j]);
+                }
+            }
+            if(op->status != E_SUCCESS) {
+                p = op_reply + REPLY_OP; //no partial reads
+            }
+        }
+        UINT8 *q = wr32(op_reply, op->status);
+        q = wr16(q, op->op == CONTROL_OP_GET && op->status != E_SUCCESS ? 0 : op->count);
+        wr16(q, op->reply_flags);
+    }
+    wr32(reply + 4, p - reply - CONTROL_FRAME_HEADER);
+    return p - reply;
+}
+
+static void frame_ack(const Control_ack_t *ack, void *user) {
+    Frame_ctx_t *ctx = user;
+    Frame_op_t *op = &ctx->op[ctx->write_op[ctx->acked++]];
+    ctx->block = ack->block;
+    if(ack->status == CONTROL_COALESCED) {
+        op->reply_flags |= CONTROL_OP_COALESCED;
+    } else if(ack->status == CONTROL_FAILED && op->status == E_SUCCESS) {
+        op->status = ack->error;
+    }
+    if(ctx->acked == ctx->writes) {
+        UINT8 reply[CONTROL_FRAME_MAX];
+        int n = frame_reply(ctx, reply);
+        ctx->done(reply, n, ctx->user);
+        free(ctx);
+    }
+}
+
+int control_frame(const UINT8 *frame, size_t len, UINT8 *reply, size_t reply_len, Control_frame_done_t done,
+                  void *user) {
+    Control_write_t writes[CONTROL_BATCH_MAX];
+    size_t reply_size = 0;
+    if(len < CONTROL_FRAME_HEADER || control_frame_size(frame, len) != (long)len) {
+        return control_frame_error(E_BADPACKET, reply, reply_len);
+    }
+    if(frame[1] != CONTROL_FRAME_VERSION) {
+        return control_frame_error(E_ARGUMENT_ERROR, reply, reply_len);
+    }
+    UINT32 op_count = rd16(frame + 2);
+    Frame_ctx_t *ctx = calloc(1, sizeof(*ctx) + op_count * sizeof(Frame_op_t));
+    if(!ctx) {
+        return control_frame_error(E_NO_HEAP_MEMORY, reply, reply_len);
+    }
+    ctx->op_count = op_count;
+    ctx->done = done;
+    ctx->user = user;
+    INT32 status = parse_ops(frame + CONTROL_FRAME_HEADER, frame + len, ctx, writes, &reply_size);
+    if(status == E_SUCCESS && (reply_size > reply_len || reply_size > CONTROL_FRAME_MAX)) {
+        status = E_MESSAGE_LENGTH_TOO_LONG;
+    }
+    if(status == E_SUCCESS && ctx->writes && control_submit_batch(writes, ctx->writes, frame_ack, ctx) < 0) {
+        status = E_OUT_OF_SPACE; //control queue full
+    }
+    if(status != E_SUCCESS) {
+        free(ctx);
+        return control_frame_error(status, reply, reply_len);
+    }
+    count_frames++;
+    count_ops += op_count;
+    if(ctx->writes) {
+        return CONTROL_REPLY_LATER;
+    }
+    int n = frame_reply(ctx, reply);
+    free(ctx);
+    return n;
+}
+
+int format_frame_stats(char *buf, size_t len) {
+    return snprintf(buf, len, "control frames %lu ops %lu rejected %lu\n", count_frames, count_ops, count_rejected);
+}
@@ -0,0 +1,241 @@
+#include<pthread.h>
+#include<stdatomic.h>
+#include<sys/eventfd.h>
+#include"../inc/sound_process.h"
+
+#define QUEUE_MASK (CONTROL_QUEUE_SIZE - 1)
+
+/*
+ * Bounded MPSC ring, one sequence word per slot: pos = free for ticket pos,
+ * pos + 1 = queued. A slot stays taken after it is applied until the ack is
+ * reaped, then it becomes free for pos + CONTROL_QUEUE_SIZE.
+ */
+typedef struct {
+    atomic_ulong seq;
+    Control_write_t write;
+    Control_done_t done;
+    void *user;
+    UINT64 submit_ns;
+    Control_ack_t ack;
+} Control_slot_t;
+
+static Control_slot_t slots[CONTROL_QUEUE_SIZE];
+static atomic_ulong head;    //next ticket, producers
+static unsigned long next;   //next to apply: the audio thread, control_reap after shutdown
+static atomic_ulong applied; //acks below this are written
+static unsigned long reaped; //control thread
+static atomic_int shut_down;
+static UINT64 final_block;
+static pthread_mutex_t reap_lock = PTHREAD_MUTEX_INITIALIZER;
+static int event_fd = -1;
+
+static atomic_ulong count_applied, count_coalesced, count_failed, count_rejected;
+static Latency_hist_t apply_hist;
+
+int control_queue_init(void) {
+    for(unsigned long i = 0; i < CONTROL_QUEUE_SIZE; i++) {
+        atomic_init(&slots[i].seq, i);
+    }
+    event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(event_fd < 0) {
+        perror("eventfd");
+        return -1;
+    }
+    return 0;
+}
+
+int control_queue_fd(void) {
+    return event_fd;
+}
+
+static void wake_reaper(void) {
+    UINT64 one = 1;
+    if(write(event_fd, &one, sizeof(one)) < 0) {
+        /*Counter saturated, the reaper is awake anyway*/
+    }
+}
+
+/*Claims count consecutive tickets, the first one, or -1 when the ring is that full*/
+static long claim(UINT32 count) {
+    unsigned long pos = atomic_load_explicit(&head, memory_order_relaxed);
+    while(1) {
+        /*Slots are freed in ticket order: the last one free means all of them are*/
+        Control_slot_t *first = &slots[pos & QUEUE_MASK];
+        Control_slot_t *last = &slots[(pos + count - 1) & QUEUE_MASK];
+        long diff = (long)(atomic_load_explicit(&first->seq, memory_order_acquire) - pos);
+        long last_diff = (long)(atomic_load_explicit(&last->seq, memory_order_acquire) - (pos + count - 1));
+        if(diff == 0 && last_diff == 0) {
+            if(atomic_compare_exchange_weak_explicit(&head, &pos, pos + count, memory_order_relaxed,
+                                                     memory_order_relaxed)) {
+                return (long)pos;
+            }
+        } else if(diff < 0 || (diff == 0 && last_diff < 0)) {
+            atomic_fetch_add_explicit(&count_rejected, count, memory_order_relaxed);
+            return -1;
+        } else {
+            pos = atomic_load_explicit(&head, memory_order_relaxed);
+        }
+    }
+}
+
+static void publish(unsigned long pos, const Control_write_t *write, Control_done_t done, void *user,
+                    UINT64 now) {
+    Control_slot_t *slot = &slots[pos & QUEUE_MASK];
+    slot->write = *write;
+    slot->done = done;
+    slot->user = user;
+    slot->submit_ns = now;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+}
+
+long control_submit(const Control_write_t *write, Control_done_t done, void *user) {
+    if(write->count == 0 || write->count > CONTROL_MAX_WORDS || write->group_left != 0) {
+        return -1;
+    }
+    long pos = claim(1);
+    if(pos < 0) {
+        return -1;
+    }
+    publish(pos, write, done, user, hist_now_ns());
+    if(atomic_load_explicit(&shut_down, memory_order_acquire)) {
+        wake_reaper();
+    }
+    return pos;
+}
+
+long control_submit_batch(Control_write_t *writes, UINT32 count, Control_done_t done, void *user) {
+    if(count == 0 || count > CONTROL_BATCH_MAX) {
+        return -1;
+    }
+    for(UINT32 i = 0; i < count; i++) {
+        if(writes[i].count == 0 || writes[i].count > CONTROL_MAX_WORDS) {
+            return -1;
+        }
+        writes[i].group_left = count - 1 - i;
+    }
+    long pos = claim(count);
+    if(pos < 0) {
+        return -1;
+    }
+    const UINT64 now = hist_now_ns();
+    for(UINT32 i = 0; i < count; i++) {
+        publish(pos + i, &writes[i], done, user, now);
+    }
+    if(atomic_load_explicit(&shut_down, memory_order_acquire)) {
+        wake_reaper();
+    }
+    return pos;
+}
+
+static int same_target(const Control_write_t *a, const Control_write_t *b) {
+    return a->handle == b->handle && a->offset == b->offset && a->count == b->count &&
+           a->masked == b->masked && (!a->masked || a->mask == b->mask);
+}
+
+/*
+ * Applies up to CONTROL_DRAIN_MAX queued writes in order, 0 if there were
+ * none. A group is applied whole: it may run past the limit, and one that
+ * is still being published waits for the next block.
+ */
+static int apply_batch(UINT64 block) {
+    Control_slot_t *batch[CONTROL_DRAIN_MAX + CONTROL_BATCH_MAX];
+    int n = 0, group_start = 0;
+    while(n < CONTROL_DRAIN_MAX || (n > 0 && batch[n - 1]->write.group_left)) {
+        Control_slot_t *slot = &slots[(next + n) & QUEUE_MASK];
+        if(atomic_load_explicit(&slot->seq, memory_order_acquire) != next + n + 1) {
+            break;
+        }
+        if(n == 0 || !batch[n - 1]->write.group_left) {
+            group_start = n;
+        }
+        batch[n++] = slot;
+    }
+    if(n > 0 && batch[n - 1]->write.group_left) {
+        n = group_start;
+    }
+    if(n == 0) {
+        return 0;
+    }
+    const UINT64 now = hist_now_ns();
+    for(int i = 0; i < n; i++) {
+        Control_write_t *w = &batch[i]->write;
+        Control_ack_t *ack = &batch[i]->ack;
+        ack->ticket = next + i;
+        ack->block = block;
+        ack->error = E_SUCCESS;
+        ack->latency_ns = now - batch[i]->submit_ns;
+        ack->status = CONTROL_APPLIED;
+        for(int j = i + 1; j < n; j++) {
+            if(same_target(w, &batch[j]->write)) {
+                ack->status = CONTROL_COALESCED;
+                break;
+            }
+        }
+        if(ack->status == CONTROL_COALESCED) {
+            atomic_fetch_add_explicit(&count_coalesced, 1, memory_order_relaxed);
+        } else if((ack->error = w->masked ? aweOS_ctrlSetValueMask(awe, w->handle, w->value, w->offset, w->count, w->mask)
+                                          : aweOS_ctrlSetValue(awe, w->handle, w->value, w->offset, w->count)) != E_SUCCESS) {
+            ack->status = CONTROL_FAILED;
+            atomic_fetch_add_explicit(&count_failed, 1, memory_order_relaxed);
+        } else {
+            atomic_fetch_add_explicit(&count_applied, 1, memory_order_relaxed);
+        }
+        hist_record(&apply_hist, ack->latency_ns);
+    }
+    next += n;
+    atomic_store_explicit(&applied, next, memory_order_release);
+    wake_reaper();
+    return n;
+}
+
+void control_apply(UINT64 block) {
+    apply_batch(block);
+}
+
+void control_queue_shutdown(UINT64 block) {
+    while(apply_batch(block) > 0) {
+    }
+    final_block = block;
+    atomic_store_explicit(&shut_down, 1, memory_order_release);
+    wake_reaper();
+}
+
+void control_reap(void) {
+    pthread_mutex_lock(&reap_lock);
+    if(atomic_load_explicit(&shut_down, memory_order_acquire)) {
+        /*Nothing pumps any more, apply right here*/
+        while(apply_batch(final_block) > 0) {
+        }
+    }
+    const unsigned long end = atomic_load_explicit(&applied, memory_order_acquire);
+    for(; reaped < end; reaped++) {
+        Control_slot_t *slot = &slots[reaped & QUEUE_MASK];
+        if(slot->done) {
+            slot->done(&slot->ack, slot->user);
+        }
+        atomic_store_explicit(&slot->seq, reaped + CONTROL_QUEUE_SIZE, memory_order_release);
+    }
+    pthread_mutex_unlock(&reap_lock);
+}
+
+int control_format_ack(const Control_ack_t *ack, char *buf, size_t len) {
+    int n;
+    switch(ack->status) {
+    case CONTROL_APPLIED:   n = snprintf(buf, len, "OK block %llu\n", (unsigned long long)ack->block); break;
+    case CONTROL_COALESCED: n = snprintf(buf, len, "OK block %llu (coalesced)\n", (unsigned long long)ack->block); break;
+    default:                n = snprintf(buf, len, "Error: %s\n", aweOS_errorToString(ack->error)); break;
+    }
+    return n < (int)len ? n : (int)len - 1;
+}
+
+int format_control_stats(char *buf, size_t len) {
+    char lat[128];
+    hist_format(&apply_hist, lat, sizeof(lat));
+    return snprintf(buf, len, "control applied %lu coalesced %lu failed %lu rejected %lu, in flight %lu, %s\n",
+                    atomic_load_explicit(&count_applied, memory_order_relaxed),
+                    atomic_load_explicit(&count_coalesced, memory_order_relaxed),
+                    atomic_load_explicit(&count_failed, memory_order_relaxed),
+                    atomic_load_explicit(&count_rejected, memory_order_relaxed),
+                    atomic_load_explicit(&head, memory_order_relaxed) -
+                        atomic_load_explicit(&applied, memory_order_relaxed), lat);
+}
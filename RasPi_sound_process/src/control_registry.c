@@ -0,0 +1,244 @@
+#include<ctype.h>
+#include"../inc/sound_process.h"
+
+#define SLOT_EMPTY (-1)
+
+/*Open addressing, linear probing, indexes into control_objects*/
+typedef struct {
+    int *slot;
+    UINT32 mask;
+} Hash_table_t;
+
+static Hash_table_t by_handle, by_name, by_id;
+
+static UINT32 hash_u32(UINT32 x) {
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    return x ^ (x >> 16);
+}
+
+static UINT32 hash_str(const char *s, size_t len) {
+    UINT32 h = 2166136261u;
+    for(size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    }
+    return h;
+}
+
+static int table_alloc(Hash_table_t *t) {
+    UINT32 size = 8;
+    while(size < 2 * control_object_count) {
+        size *= 2;
+    }
+    t->slot = malloc(size * sizeof(int));
+    if(!t->slot) {
+        return -1;
+    }
+    for(UINT32 i = 0; i < size; i++) {
+        t->slot[i] = SLOT_EMPTY;
+    }
+    t->mask = size - 1;
+    return 0;
+}
+
+static void table_insert(Hash_table_t *t, UINT32 hash, int index) {
+    UINT32 i = hash & t->mask;
+    while(t->slot[i] != SLOT_EMPTY) {
+        i = (i + 1) & t->mask;
+    }
+    t->slot[i] = index;
+}
+
+int control_registry_init(void) {
+    if(table_alloc(&by_handle) != 0 || table_alloc(&by_name) != 0 || table_alloc(&by_id) != 0) {
+        return -1;
+    }
+    for(UINT32 i = 0; i < control_object_count; i++) {
+        const Control_object_t *obj = &control_objects[i];
+        table_insert(&by_handle, hash_u32(obj->handle), i);
+        table_insert(&by_name, hash_str(obj->name, strlen(obj->name)), i);
+        if(obj->primary) {
+            table_insert(&by_id, hash_u32(obj->object_id), i);
+        }
+    }
+    printf("Control registry: %u parameters\n", control_object_count);
+    return 0;
+}
+
+const Control_object_t *control_find_handle(UINT32 handle) {
+    for(UINT32 i = hash_u32(handle) & by_handle.mask; by_handle.slot[i] != SLOT_EMPTY; i = (i + 1) & by_handle.mask) {
+        if(control_objects[by_handle.slot[i]].handle == handle) {
+            return &control_objects[by_handle.slot[i]];
+        }
+    }
+    return NULL;
+}
+
+const Control_object_t *control_find_name(const char *name, size_t len) {
+    for(UINT32 i = hash_str(name, len) & by_name.mask; by_name.slot[i] != SLOT_EMPTY; i = (i + 1) & by_name.mask) {
+        const Control_object_t *obj = &control_objects[by_name.slot[i]];
+        if(strncmp(obj->name, name, len) == 0 && obj->name[len] == 0) {
+            return obj;
+        }
+    }
+    return NULL;
+}
+
+const Control_object_t *control_find_id(UINT32 object_id) {
+    for(UINT32 i = hash_u32(object_id) & by_id.mask; by_id.slot[i] != SLOT_EMPTY; i = (i + 1) & by_id.mask) {
+        if(control_objects[by_id.slot[i]].object_id == object_id) {
+            return &control_objects[by_id.slot[i]];
+        }
+    }
+    return NULL;
+}
+
+const Control_object_t *control_resolve(const char *ref, int *index, const char **rest) {
+    const Control_object_t *obj;
+    while(isspace((unsigned char)*ref)) {
+        ref++;
+    }
+    size_t len = strcspn(ref, " \t[");
+    *index = -1;
+    if(isdigit((unsigned char)*ref)) {
+        char *end;
+        unsigned long v = strtoul(ref, &end, 0);
+        if(end != ref + len) {
+            return NULL;
+        }
+        obj = control_find_handle(v);
+        if(!obj) {
+            obj = control_find_id(v);
+        }
+    } else {
+        obj = control_find_name(ref, len);
+    }
+    ref += len;
+    if(*ref == '[') {
+        char *end;
+        long i = strtol(ref + 1, &end, 10);
+        if(end == ref + 1 || *end != ']' || i < 0) {
+            return NULL;
+        }
+        *index = (int)i;
+        ref = end + 1;
+    }
+    *rest = ref;
+    return obj;
+}
+
+int control_check_word(const Control_object_t *obj, INT32 word) {
+    double v;
+    if(!obj->has_range) {
+        return 0;
+    }
+    if(obj->type == CONTROL_TYPE_FLOAT) {
+        FLOAT32 f;
+        memcpy(&f, &word, sizeof(f));
+        v = f;
+    } else if(obj->type == CONTROL_TYPE_UINT) {
+        v = (UINT32)word;
+    } else {
+        v = word;
+    }
+    return v >= obj->min && v <= obj->max ? 0 : -1;
+}
+
+/*One number of obj's type, within its range*/
+static int parse_value(const Control_object_t *obj, const char *p, char **end, INT32 *word) {
+    if(obj->type == CONTROL_TYPE_FLOAT) {
+        FLOAT32 f = strtof(p, end);
+        memcpy(word, &f, sizeof(f));
+    } else if(obj->type == CONTROL_TYPE_UINT) {
+        *word = (INT32)(UINT32)strtoul(p, end, 0);
+    } else {
+        *word = (INT32)strtol(p, end, 0);
+    }
+    if(*end == p || (**end && !isspace((unsigned char)**end))) {
+        return -1;
+    }
+    return control_check_word(obj, *word);
+}
+
+int control_parse_values(const Control_object_t *obj, int index, const char *text, Control_write_t *w,
+                         char *err, size_t len) {
+    const UINT32 offset = index < 0 ? 0 : (UINT32)index;
+    UINT32 count = 0;
+    if(offset >= obj->size) {
+        snprintf(err, len, "Index out of range, %s has %u", obj->name, obj->size);
+        return -1;
+    }
+    while(1) {
+        while(isspace((unsigned char)*text)) {
+            text++;
+        }
+        if(!*text) {
+            break;
+        }
+        if(offset + count >= obj->size || count >= CONTROL_MAX_WORDS) {
+            snprintf(err, len, "Too many values, %s has %u", obj->name, obj->size);
+            return -1;
+        }
+        char *end;
+        if(parse_value(obj, text, &end, &w->value[count]) != 0) {
+            if(obj->has_range) {
+                snprintf(err, len, "Invalid value, %s range %g to %g", obj->name, obj->min, obj->max);
+            } else {
+                snprintf(err, len, "Invalid value");
+            }
+            return -1;
+        }
+        count++;
+        text = end;
+    }
+    if(count == 0) {
+        snprintf(err, len, "Invalid format");
+        return -1;
+    }
+    w->handle = obj->handle;
+    w->offset = offset;
+    w->count = count;
+    w->masked = 0;
+    w->group_left = 0;
+    return 0;
+}
+
+static const char *type_name(Control_type_t type) {
+    return type == CONTROL_TYPE_FLOAT ? "float" : type == CONTROL_TYPE_UINT ? "uint" : "int";
+}
+
+int control_format_values(const Control_object_t *obj, UINT32 offset, const INT32 *words, UINT32 count,
+                          char *buf, size_t len) {
+    int n = obj->size > 1 ? snprintf(buf, len, "%s[%u] =", obj->name, offset) : snprintf(buf, len, "%s =", obj->name);
+    for(UINT32 i = 0; i < count && n < (int)len; i++) {
+        if(obj->type == CONTROL_TYPE_FLOAT) {
+            FLOAT32 f;
+            memcpy(&f, &words[i], sizeof(f));
+            n += snprintf(buf + n, len - n, " %g", f);
+        } else if(obj->type == CONTROL_TYPE_UINT) {
+            n += snprintf(buf + n, len - n, " %u", (UINT32)words[i]);
+        } else {
+            n += snprintf(buf + n, len - n, " %d", words[i]);
+        }
+    }
+    if(n < (int)len) {
+        n += snprintf(buf + n, len - n, "\n");
+    }
+    return n < (int)len ? n : (int)len - 1;
+}
+
+int format_control_list(char *buf, size_t len) {
+    int n = 0;
+    for(UINT32 i = 0; i < control_object_count && n < (int)len; i++) {
+        const Control_object_t *obj = &control_objects[i];
+        char range[48] = "";
+        if(obj->has_range) {
+            snprintf(range, sizeof(range), " range %g to %g", obj->min, obj->max);
+        }
+        n += snprintf(buf + n, len - n, "%-26s %s[%u] id %u handle 0x%08X%s%s\n", obj->name, type_name(obj->type),
+                      obj->size, obj->object_id, obj->handle, range, obj->primary ? " (primary)" : "");
+    }
+    return n < (int)len ? n : (int)len - 1;
+}
@@ -0,0 +1,331 @@
+#include<errno.h>
+#include<fcntl.h>
+#include<sys/epoll.h>
+#include"../inc/sound_process.h"
+
+typedef struct Control_conn {
+    int fd;                 //-1 once closed
+    char in[TCP_BUFF_SIZE]; //received, not yet handled: text lines and binary frames
+    size_t in_len;
+    int overlong;           //dropping the rest of a line that didn't fit
+    char *out;              //replies not sent yet
+    size_t out_len;
+    size_t out_cap;
+    int closing;            //"exit": close once out is flushed
+    int waiting;            //a write or frame is queued, later input waits for its ack
+    UINT32 events;          //registered with epoll
+    struct Control_conn *next_free;
+} Control_conn_t;
+
+static int epoll_fd = -1;
+static int num_clients;
+static char ack_marker; //epoll tag of the control queue eventfd
+/*Closed this round; freed after it, the ack or a later event may still point here*/
+static Control_conn_t *graveyard;
+
+static void conn_bury(Control_conn_t *conn) {
+    conn->next_free = graveyard;
+    graveyard = conn;
+}
+
+static void conn_close(Control_conn_t *conn) {
+    printf("Client %d disconnected\n", conn->fd);
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    conn->fd = -1;
+    num_clients--;
+    if(!conn->waiting) {
+        conn_bury(conn); //else conn_ack does
+    }
+}
+
+/*Queue a reply, -1 once the client has fallen too far behind*/
+static int conn_queue(Control_conn_t *conn, const char *data, size_t len) {
+    if(conn->out_len + len > conn->out_cap) {
+        size_t cap = conn->out_cap ? conn->out_cap : TCP_REPLY_SIZE;
+        while(cap < conn->out_len + len) {
+            cap *= 2;
+        }
+        if(cap > CONTROL_OUT_MAX) {
+            fprintf(stderr, "Client %d is not reading, dropping it\n", conn->fd);
+            return -1;
+        }
+        char *out = realloc(conn->out, cap);
+        if(!out) {
+            return -1;
+        }
+        conn->out = out;
+        conn->out_cap = cap;
+    }
+    memcpy(conn->out + conn->out_len, data, len);
+    conn->out_len += len;
+    return 0;
+}
+
+/*
+ * Send what the socket takes. EPOLLOUT only while replies are left, no
+ * EPOLLIN while an ack is due or "exit" is pending, so replies stay in order.
+ */
+static int conn_flush(Control_conn_t *conn) {
+    size_t sent = 0;
+    while(sent < conn->out_len) {
+        ssize_t n = send(conn->fd, conn->out + sent, conn->out_len - sent, MSG_NOSIGNAL);
+        if(n < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return -1;
+        }
+        sent += n;
+    }
+    memmove(conn->out, conn->out + sent, conn->out_len - sent);
+    conn->out_len -= sent;
+    if(conn->closing && conn->out_len == 0) {
+        return -1;
+    }
+    UINT32 events = (conn->waiting || conn->closing ? 0 : EPOLLIN | EPOLLRDHUP) | (conn->out_len ? EPOLLOUT : 0);
+    if(events == conn->events) {
+        return 0;
+    }
+    struct epoll_event ev = { events, { .ptr = conn } };
+    conn->events = events;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+}
+
+static void conn_ack(const Control_ack_t *ack, void *user);
+static void conn_frame_done(const UINT8 *reply, size_t len, void *user);
+
+static int conn_line(Control_conn_t *conn, char *line) {
+    char reply[TCP_REPLY_SIZE];
+    line[strcspn(line, "\r")] = 0;
+    if(!line[0]) {
+        return 0;
+    }
+    printf("Client %d: %s\n", conn->fd, line);
+    int n = control_command(line, reply, sizeof(reply), conn_ack, conn);
+    if(n == CONTROL_REPLY_LATER) {
+        conn->waiting = 1;
+        return 0;
+    }
+    if(n < 0) {
+        conn->closing = 1;
+        return 0;
+    }
+    return conn_queue(conn, reply, n);
+}
+
+static int conn_frame(Control_conn_t *conn, const UINT8 *frame, size_t len) {
+    UINT8 reply[CONTROL_FRAME_MAX];
+    int n = control_frame(frame, len, reply, sizeof(reply), conn_frame_done, conn);
+    if(n == CONTROL_REPLY_LATER) {
+        conn->waiting = 1;
+        return 0;
+    }
+    return conn_queue(conn, (const char *)reply, n);
+}
+
+/*
+ * Handle the complete lines and frames in conn->in, until one has to wait
+ * for its ack. A frame header we can't take leaves no way to find the next
+ * command: reply with the error and close.
+ */
+static int conn_process(Control_conn_t *conn) {
+    size_t start = 0;
+    int err = 0;
+    while(!conn->waiting && !conn->closing && err == 0) {
+        if(!conn->overlong && start < conn->in_len && (UINT8)conn->in[start] == CONTROL_FRAME_MAGIC) {
+            const UINT8 *frame = (const UINT8 *)conn->in + start;
+            long size = control_frame_size(frame, conn->in_len - start);
+            if(size == 0 || (size > 0 && (size_t)size > conn->in_len - start)) {
+                break;
+            }
+            if(size < 0) {
+                UINT8 reply[64];
+                err = conn_queue(conn, (const char *)reply, control_frame_error(E_MESSAGE_LENGTH_TOO_LONG, reply,
+                                                                                 sizeof(reply)));
+                conn->closing = 1;
+                start = conn->in_len;
+                break;
+            }
+            err = conn_frame(conn, frame, size);
+            start += size;
+            continue;
+        }
+        char *nl = memchr(conn->in + start, '\n', conn->in_len - start);
+        if(!nl) {
+            break;
+        }
+        *nl = 0;
+        err = conn->overlong ? conn_queue(conn, "Line too long\n", 14) : conn_line(conn, conn->in + start);
+        conn->overlong = 0;
+        start = nl - conn->in + 1;
+    }
+    memmove(conn->in, conn->in + start, conn->in_len - start);
+    conn->in_len -= start;
+    if(conn->in_len == sizeof(conn->in) && (UINT8)conn->in[0] != CONTROL_FRAME_MAGIC &&
+       !memchr(conn->in, '\n', conn->in_len)) {
+        conn->overlong = 1;
+        conn->in_len = 0;
+    }
+    return err;
+}
+
+/*
+ * A line may span several recv calls. One recv per wakeup: epoll is level
+ * triggered and comes back for the rest, so a chatty client can't starve
+ * the others.
+ */
+static int conn_read(Control_conn_t *conn) {
+    ssize_t n;
+    if(conn->waiting || conn->closing) {
+        return 0;
+    }
+    do {
+        n = recv(conn->fd, conn->in + conn->in_len, sizeof(conn->in) - conn->in_len, 0);
+    } while(n < 0 && errno == EINTR);
+    if(n == 0) {
+        return -1;
+    }
+    if(n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    }
+    conn->in_len += n;
+    return conn_process(conn);
+}
+
+/*Reply to the write that was waiting, then carry on with the lines behind it*/
+static void conn_ack(const Control_ack_t *ack, void *user) {
+    Control_conn_t *conn = user;
+    char reply[64];
+    conn->waiting = 0;
+    if(conn->fd < 0) {
+        conn_bury(conn);
+        return;
+    }
+    int n = control_format_ack(ack, reply, sizeof(reply));
+    if(conn_queue(conn, reply, n) != 0 || conn_process(conn) != 0 || conn_flush(conn) != 0) {
+        conn_close(conn);
+    }
+}
+
+/*The frame that was waiting has its reply, same as conn_ack*/
+static void conn_frame_done(const UINT8 *reply, size_t len, void *user) {
+    Control_conn_t *conn = user;
+    conn->waiting = 0;
+    if(conn->fd < 0) {
+        conn_bury(conn);
+        return;
+    }
+    if(conn_queue(conn, (const char *)reply, len) != 0 || conn_process(conn) != 0 || conn_flush(conn) != 0) {
+        conn_close(conn);
+    }
+}
+
+static void accept_clients(int server_fd) {
+    while(1) {
+        int fd = accept4(server_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("accept4");
+            }
+            return;
+        }
+        if(num_clients >= CONTROL_MAX_CLIENTS) {
+            send(fd, "Too many clients\n", 17, MSG_NOSIGNAL);
+            close(fd);
+            continue;
+        }
+        Control_conn_t *conn = calloc(1, sizeof(*conn));
+        struct epoll_event ev = { EPOLLIN | EPOLLRDHUP, { .ptr = conn } };
+        if(!conn || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            free(conn);
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->events = ev.events;
+        num_clients++;
+        printf("Client %d connected, %d open\n", fd, num_clients);
+    }
+}
+
+static int watch(int fd, void *tag) {
+    struct epoll_event ev = { EPOLLIN, { .ptr = tag } };
+    if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        perror("epoll_ctl");
+        return -1;
+    }
+    return 0;
+}
+
+int control_server_run(int server_fd) {
+    struct epoll_event events[CONTROL_MAX_CLIENTS + 2];
+    int flags = fcntl(server_fd, F_GETFL);
+    if(flags < 0 || fcntl(server_fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+        perror("fcntl");
+        return -1;
+    }
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(epoll_fd < 0) {
+        perror("epoll_create1");
+        return -1;
+    }
+    /*The listening socket is tagged NULL, the control queue eventfd &ack_marker*/
+    if(watch(server_fd, NULL) != 0 || watch(control_queue_fd(), &ack_marker) != 0) {
+        return -1;
+    }
+    printf("Server is listening at port: %d\n", TCP_PORT_NO);
+
+    while(1) {
+        int n = epoll_wait(epoll_fd, events, CONTROL_MAX_CLIENTS + 2, -1);
+        if(n < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            return -1;
+        }
+        for(int i = 0; i < n; i++) {
+            void *tag = events[i].data.ptr;
+            if(!tag) {
+                accept_clients(server_fd);
+                continue;
+            }
+            if(tag == &ack_marker) {
+                UINT64 count;
+                if(read(control_queue_fd(), &count, sizeof(count)) > 0) {
+                    control_reap();
+                }
+                continue;
+            }
+            Control_conn_t *conn = tag;
+            if(conn->fd < 0) {
+                continue; //closed by an ack earlier in this round
+            }
+            int err = 0;
+            if(events[i].events & (EPOLLHUP | EPOLLERR)) {
+                err = -1;
+            } else if(events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                err = conn_read(conn);
+            }
+            if(err != 0) {
+                conn_flush(conn); //best effort, replies to what came before the hang-up
+                conn_close(conn);
+            } else if(conn_flush(conn) != 0) {
+                conn_close(conn);
+            }
+        }
+        while(graveyard) {
+            Control_conn_t *conn = graveyard;
+            graveyard = conn->next_free;
+            free(conn->out);
+            free(conn);
+        }
+    }
+}
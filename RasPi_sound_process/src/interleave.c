@@ -0,0 +1,695 @@
+#include<string.h>
+#include"../inc/interleave.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86_KERNELS 1
+#include<immintrin.h>
+#define SSE2 __attribute__((target("sse2")))
+#define AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAVE_NEON_KERNELS 1
+#include<arm_neon.h>
+#endif
+
+/*
+ * A kernel converts whole vectors only and returns how many frames it did,
+ * the scalar loop finishes the rest. Planar channel c starts at c * frames.
+ */
+typedef UINT32 (*Kernel_fn)(void *dst, const void *src, UINT32 frames);
+
+enum { OP_DEINTERLEAVE, OP_INTERLEAVE, OP_COUNT };
+enum { W_S16, W_S32, W_COUNT };
+enum { CH_2, CH_4, CH_8, CH_COUNT };
+
+static Kernel_fn kernels[OP_COUNT][W_COUNT][CH_COUNT];
+static const char *kernel_isa[OP_COUNT][W_COUNT][CH_COUNT];
+static const char *active_isa = "scalar";
+
+/*Scalar reference, also handles any channel count*/
+#define SCALAR_KERNELS(T, sfx)                                                              \
+static void scalar_deinterleave_##sfx(T *p, const T *in, UINT32 ch, UINT32 i, UINT32 n) {  \
+    for(; i < n; i++) {                                                                     \
+        for(UINT32 c = 0; c < ch; c++) {                                                    \
+            p[c * n + i] = in[i * ch + c];                                                  \
+        }                                                                                   \
+    }                                                                                       \
+}                                                                                           \
+static void scalar_interleave_##sfx(T *out, const T *p, UINT32 ch, UINT32 i, UINT32 n) {   \
+    for(; i < n; i++) {                                                                     \
+        for(UINT32 c = 0; c < ch; c++) {                                                    \
+            out[i * ch + c] = p[c * n + i];                                                 \
+        }                                                                                   \
+    }                                                                                       \
+}
+
+SCALAR_KERNELS(INT32, s32)
+SCALAR_KERNELS(INT16, s16)
+
+#ifdef HAVE_X86_KERNELS
+#define LD(p) _mm_loadu_si128((const __m128i *)(p))
+#define ST(p, v) _mm_storeu_si128((__m128i *)(p), (v))
+
+/*
+ * Transposes work on named registers: with arrays and small loops GCC -O2
+ * does not unroll and spills every vector to the stack.
+ */
+
+/*4x4 transpose of 32-bit lanes, its own inverse*/
+#define TRANSPOSE4_EPI32(r0, r1, r2, r3) do {                   \
+    __m128i t0_ = _mm_unpacklo_epi32(r0, r1);                   \
+    __m128i t1_ = _mm_unpacklo_epi32(r2, r3);                   \
+    __m128i t2_ = _mm_unpackhi_epi32(r0, r1);                   \
+    __m128i t3_ = _mm_unpackhi_epi32(r2, r3);                   \
+    r0 = _mm_unpacklo_epi64(t0_, t1_);                          \
+    r1 = _mm_unpackhi_epi64(t0_, t1_);                          \
+    r2 = _mm_unpacklo_epi64(t2_, t3_);                          \
+    r3 = _mm_unpackhi_epi64(t2_, t3_);                          \
+} while(0)
+
+/*8x8 transpose of 16-bit lanes, its own inverse*/
+#define TRANSPOSE8_EPI16(r0, r1, r2, r3, r4, r5, r6, r7) do {                                 \
+    __m128i a0_ = _mm_unpacklo_epi16(r0, r1), a1_ = _mm_unpackhi_epi16(r0, r1);               \
+    __m128i a2_ = _mm_unpacklo_epi16(r2, r3), a3_ = _mm_unpackhi_epi16(r2, r3);               \
+    __m128i a4_ = _mm_unpacklo_epi16(r4, r5), a5_ = _mm_unpackhi_epi16(r4, r5);               \
+    __m128i a6_ = _mm_unpacklo_epi16(r6, r7), a7_ = _mm_unpackhi_epi16(r6, r7);               \
+    __m128i b0_ = _mm_unpacklo_epi32(a0_, a2_), b1_ = _mm_unpackhi_epi32(a0_, a2_);           \
+    __m128i b2_ = _mm_unpacklo_epi32(a1_, a3_), b3_ = _mm_unpackhi_epi32(a1_, a3_);           \
+    __m128i b4_ = _mm_unpacklo_epi32(a4_, a6_), b5_ = _mm_unpackhi_epi32(a4_, a6_);           \
+    __m128i b6_ = _mm_unpacklo_epi32(a5_, a7_), b7_ = _mm_unpackhi_epi32(a5_, a7_);           \
+    r0 = _mm_unpacklo_epi64(b0_, b4_); r1 = _mm_unpackhi_epi64(b0_, b4_);                     \
+    r2 = _mm_unpacklo_epi64(b1_, b5_); r3 = _mm_unpackhi_epi64(b1_, b5_);                     \
+    r4 = _mm_unpacklo_epi64(b2_, b6_); r5 = _mm_unpackhi_epi64(b2_, b6_);                     \
+    r6 = _mm_unpacklo_epi64(b3_, b7_); r7 = _mm_unpackhi_epi64(b3_, b7_);                     \
+} while(0)
+
+static SSE2 UINT32 sse2_deinterleave_s32x2(void *dst, const void *src, UINT32 n) {
+    INT32 *p = dst;
+    const INT32 *in = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        __m128 a = _mm_castsi128_ps(LD(in + 2 * i));
+        __m128 b = _mm_castsi128_ps(LD(in + 2 * i + 4));
+        ST(p + i,     _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))));
+        ST(p + n + i, _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+    return i;
+}
+
+static SSE2 UINT32 sse2_interleave_s32x2(void *dst, const void *src, UINT32 n) {
+    INT32 *out = dst;
+    const INT32 *p = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        __m128i l = LD(p + i), r = LD(p + n + i);
+        ST(out + 2 * i,     _mm_unpacklo_epi32(l, r));
+        ST(out + 2 * i + 4, _mm_unpackhi_epi32(l, r));
+    }
+    return i;
+}
+
+static SSE2 UINT32 sse2_deinterleave_s32x4(void *dst, const void *src, UINT32 n) {
+    INT32 *p = dst;
+    const INT32 *in = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        const INT32 *f = in + 4 * i;
+        __m128i r0 = LD(f), r1 = LD(f + 4), r2 = LD(f + 8), r3 = LD(f + 12);
+        TRANSPOSE4_EPI32(r0, r1, r2, r3);
+        ST(p + i, r0);
+        ST(p + n + i, r1);
+        ST(p + 2 * n + i, r2);
+        ST(p + 3 * n + i, r3);
+    }
+    return i;
+}
+
+static SSE2 UINT32 sse2_interleave_s32x4(void *dst, const void *src, UINT32 n) {
+    INT32 *out = dst;
+    const INT32 *p = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        __m128i r0 = LD(p + i), r1 = LD(p + n + i), r2 = LD(p + 2 * n + i), r3 = LD(p + 3 * n + i);
+        TRANSPOSE4_EPI32(r0, r1, r2, r3);
+        INT32 *f = out + 4 * i;
+        ST(f, r0);
+        ST(f + 4, r1);
+        ST(f + 8, r2);
+        ST(f + 12, r3);
+    }
+    return i;
+}
+
+static SSE2 UINT32 sse2_deinterleave_s32x8(void *dst, const void *src, UINT32 n) {
+    INT32 *p = dst;
+    const INT32 *in = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        const INT32 *f = in + 8 * i;
+        __m128i l0 = LD(f),      h0 = LD(f + 4);
+        __m128i l1 = LD(f + 8),  h1 = LD(f + 12);
+        __m128i l2 = LD(f + 16), h2 = LD(f + 20);
+        __m128i l3 = LD(f + 24), h3 = LD(f + 28);
+        TRANSPOSE4_EPI32(l0, l1, l2, l3);
+        TRANSPOSE4_EPI32(h0, h1, h2, h3);
+        ST(p + i, l0);
+        ST(p + n + i, l1);
+        ST(p + 2 * n + i, l2);
+        ST(p + 3 * n + i, l3);
+        ST(p + 4 * n + i, h0);
+        ST(p + 5 * n + i, h1);
+        ST(p + 6 * n + i, h2);
+        ST(p + 7 * n + i, h3);
+    }
+    return i;
+}
+
+static SSE2 UINT32 sse2_interleave_s32x8(void *dst, const void *src, UINT32 n) {
+    INT32 *out = dst;
+    const INT32 *p = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        __m128i l0 = LD(p + i),         l1 = LD(p + n + i);
+        __m128i l2 = LD(p + 2 * n + i), l3 = LD(p + 3 * n + i);
+        __m128i h0 = LD(p + 4 * n + i), h1 = LD(p + 5 * n + i);
+        __m128i h2 = LD(p + 6 * n + i), h3 = LD(p + 7 * n + i);
+        TRANSPOSE4_EPI32(l0, l1, l2, l3);
+        TRANSPOSE4_EPI32(h0, h1, h2, h3);
+        INT32 *f = out + 8 * i;
+        ST(f, l0);      ST(f + 4, h0);
+        ST(f + 8, l1);  ST(f + 12, h1);
+        ST(f + 16, l2); ST(f + 20, h2);
+        ST(f + 24, l3); ST(f + 28, h3);
+    }
+    return i;
+}
+
+static SSE2 UINT32 sse2_deinterleave_s16x2(void *dst, const void *src, UINT32 n) {
+    INT16 *p = dst;
+    const INT16 *in = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m128i v0 = LD(in + 2 * i), v1 = LD(in + 2 * i + 8);
+        __m128i a = _mm_unpacklo_epi16(v0, v1), b = _mm_unpackhi_epi16(v0, v1);
+        __m128i c = _mm_unpacklo_epi16(a, b), d = _mm_unpackhi_epi16(a, b);
+        ST(p + i,     _mm_unpacklo_epi16(c, d));
+        ST(p + n + i, _mm_unpackhi_epi16(c, d));
+    }
+    return i;
+}
+
+static SSE2 UINT32 sse2_interleave_s16x2(void *dst, const void *src, UINT32 n) {
+    INT16 *out = dst;
+    const INT16 *p = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m128i l = LD(p + i), r = LD(p + n + i);
+        ST(out + 2 * i,     _mm_unpacklo_epi16(l, r));
+        ST(out + 2 * i + 8, _mm_unpackhi_epi16(l, r));
+    }
+    return i;
+}
+
+static SSE2 UINT32 sse2_deinterleave_s16x4(void *dst, const void *src, UINT32 n) {
+    INT16 *p = dst;
+    const INT16 *in = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m128i v0 = LD(in + 4 * i), v1 = LD(in + 4 * i + 8);
+        __m128i v2 = LD(in + 4 * i + 16), v3 = LD(in + 4 * i + 24);
+        __m128i a0 = _mm_unpacklo_epi16(v0, v1), a1 = _mm_unpackhi_epi16(v0, v1);
+        __m128i a2 = _mm_unpacklo_epi16(v2, v3), a3 = _mm_unpackhi_epi16(v2, v3);
+        __m128i b0 = _mm_unpacklo_epi16(a0, a1), b1 = _mm_unpackhi_epi16(a0, a1);
+        __m128i b2 = _mm_unpacklo_epi16(a2, a3), b3 = _mm_unpackhi_epi16(a2, a3);
+        ST(p + i,         _mm_unpacklo_epi64(b0, b2));
+        ST(p + n + i,     _mm_unpackhi_epi64(b0, b2));
+        ST(p + 2 * n + i, _mm_unpacklo_epi64(b1, b3));
+        ST(p + 3 * n + i, _mm_unpackhi_epi64(b1, b3));
+    }
+    return i;
+}
+
+static SSE2 UINT32 sse2_interleave_s16x4(void *dst, const void *src, UINT32 n) {
+    INT16 *out = dst;
+    const INT16 *p = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m128i c0 = LD(p + i), c1 = LD(p + n + i);
+        __m128i c2 = LD(p + 2 * n + i), c3 = LD(p + 3 * n + i);
+        __m128i t0 = _mm_unpacklo_epi16(c0, c1), t1 = _mm_unpackhi_epi16(c0, c1);
+        __m128i t2 = _mm_unpacklo_epi16(c2, c3), t3 = _mm_unpackhi_epi16(c2, c3);
+        ST(out + 4 * i,      _mm_unpacklo_epi32(t0, t2));
+        ST(out + 4 * i + 8,  _mm_unpackhi_epi32(t0, t2));
+        ST(out + 4 * i + 16, _mm_unpacklo_epi32(t1, t3));
+        ST(out + 4 * i + 24, _mm_unpackhi_epi32(t1, t3));
+    }
+    return i;
+}
+
+static SSE2 UINT32 sse2_deinterleave_s16x8(void *dst, const void *src, UINT32 n) {
+    INT16 *p = dst;
+    const INT16 *in = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        const INT16 *f = in + 8 * i;
+        __m128i r0 = LD(f),      r1 = LD(f + 8),  r2 = LD(f + 16), r3 = LD(f + 24);
+        __m128i r4 = LD(f + 32), r5 = LD(f + 40), r6 = LD(f + 48), r7 = LD(f + 56);
+        TRANSPOSE8_EPI16(r0, r1, r2, r3, r4, r5, r6, r7);
+        ST(p + i, r0);         ST(p + n + i, r1);
+        ST(p + 2 * n + i, r2); ST(p + 3 * n + i, r3);
+        ST(p + 4 * n + i, r4); ST(p + 5 * n + i, r5);
+        ST(p + 6 * n + i, r6); ST(p + 7 * n + i, r7);
+    }
+    return i;
+}
+
+static SSE2 UINT32 sse2_interleave_s16x8(void *dst, const void *src, UINT32 n) {
+    INT16 *out = dst;
+    const INT16 *p = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m128i r0 = LD(p + i),         r1 = LD(p + n + i);
+        __m128i r2 = LD(p + 2 * n + i), r3 = LD(p + 3 * n + i);
+        __m128i r4 = LD(p + 4 * n + i), r5 = LD(p + 5 * n + i);
+        __m128i r6 = LD(p + 6 * n + i), r7 = LD(p + 7 * n + i);
+        TRANSPOSE8_EPI16(r0, r1, r2, r3, r4, r5, r6, r7);
+        INT16 *f = out + 8 * i;
+        ST(f, r0);      ST(f + 8, r1);  ST(f + 16, r2); ST(f + 24, r3);
+        ST(f + 32, r4); ST(f + 40, r5); ST(f + 48, r6); ST(f + 56, r7);
+    }
+    return i;
+}
+
+/*AVX2 only pays off for the 32-bit kernels, 16-bit stays on SSE2*/
+#define LD8(p) _mm256_loadu_si256((const __m256i *)(p))
+#define ST8(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+
+static AVX2 UINT32 avx2_deinterleave_s32x2(void *dst, const void *src, UINT32 n) {
+    INT32 *p = dst;
+    const INT32 *in = src;
+    const __m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_permutevar8x32_epi32(LD8(in + 2 * i), split);
+        __m256i b = _mm256_permutevar8x32_epi32(LD8(in + 2 * i + 8), split);
+        ST8(p + i,     _mm256_permute2x128_si256(a, b, 0x20));
+        ST8(p + n + i, _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    return i;
+}
+
+static AVX2 UINT32 avx2_interleave_s32x2(void *dst, const void *src, UINT32 n) {
+    INT32 *out = dst;
+    const INT32 *p = src;
+    const __m256i zip = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256i l = LD8(p + i), r = LD8(p + n + i);
+        ST8(out + 2 * i,     _mm256_permutevar8x32_epi32(_mm256_permute2x128_si256(l, r, 0x20), zip));
+        ST8(out + 2 * i + 8, _mm256_permutevar8x32_epi32(_mm256_permute2x128_si256(l, r, 0x31), zip));
+    }
+    return i;
+}
+
+static AVX2 UINT32 avx2_deinterleave_s32x4(void *dst, const void *src, UINT32 n) {
+    INT32 *p = dst;
+    const INT32 *in = src;
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        /*Each 128-bit lane holds one frame; even frames end up in lane 0*/
+        __m256i r0 = LD8(in + 4 * i), r1 = LD8(in + 4 * i + 8);
+        __m256i r2 = LD8(in + 4 * i + 16), r3 = LD8(in + 4 * i + 24);
+        __m256i t0 = _mm256_unpacklo_epi32(r0, r1), t1 = _mm256_unpackhi_epi32(r0, r1);
+        __m256i t2 = _mm256_unpacklo_epi32(r2, r3), t3 = _mm256_unpackhi_epi32(r2, r3);
+        ST8(p + i,         _mm256_permutevar8x32_epi32(_mm256_unpacklo_epi64(t0, t2), order));
+        ST8(p + n + i,     _mm256_permutevar8x32_epi32(_mm256_unpackhi_epi64(t0, t2), order));
+        ST8(p + 2 * n + i, _mm256_permutevar8x32_epi32(_mm256_unpacklo_epi64(t1, t3), order));
+        ST8(p + 3 * n + i, _mm256_permutevar8x32_epi32(_mm256_unpackhi_epi64(t1, t3), order));
+    }
+    return i;
+}
+
+static AVX2 UINT32 avx2_interleave_s32x4(void *dst, const void *src, UINT32 n) {
+    INT32 *out = dst;
+    const INT32 *p = src;
+    const __m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256i u0 = _mm256_permutevar8x32_epi32(LD8(p + i), split);
+        __m256i u1 = _mm256_permutevar8x32_epi32(LD8(p + n + i), split);
+        __m256i u2 = _mm256_permutevar8x32_epi32(LD8(p + 2 * n + i), split);
+        __m256i u3 = _mm256_permutevar8x32_epi32(LD8(p + 3 * n + i), split);
+        __m256i t0 = _mm256_unpacklo_epi32(u0, u1), t1 = _mm256_unpackhi_epi32(u0, u1);
+        __m256i t2 = _mm256_unpacklo_epi32(u2, u3), t3 = _mm256_unpackhi_epi32(u2, u3);
+        ST8(out + 4 * i,      _mm256_unpacklo_epi64(t0, t2));
+        ST8(out + 4 * i + 8,  _mm256_unpackhi_epi64(t0, t2));
+        ST8(out + 4 * i + 16, _mm256_unpacklo_epi64(t1, t3));
+        ST8(out + 4 * i + 24, _mm256_unpackhi_epi64(t1, t3));
+    }
+    return i;
+}
+
+/*8x8 transpose of 32-bit lanes, its own inverse*/
+#define TRANSPOSE8_EPI32(r0, r1, r2, r3, r4, r5, r6, r7) do {                                          \
+    __m256i t0_ = _mm256_unpacklo_epi32(r0, r1), t1_ = _mm256_unpackhi_epi32(r0, r1);                  \
+    __m256i t2_ = _mm256_unpacklo_epi32(r2, r3), t3_ = _mm256_unpackhi_epi32(r2, r3);                  \
+    __m256i t4_ = _mm256_unpacklo_epi32(r4, r5), t5_ = _mm256_unpackhi_epi32(r4, r5);                  \
+    __m256i t6_ = _mm256_unpacklo_epi32(r6, r7), t7_ = _mm256_unpackhi_epi32(r6, r7);                  \
+    __m256i u0_ = _mm256_unpacklo_epi64(t0_, t2_), u1_ = _mm256_unpackhi_epi64(t0_, t2_);              \
+    __m256i u2_ = _mm256_unpacklo_epi64(t1_, t3_), u3_ = _mm256_unpackhi_epi64(t1_, t3_);              \
+    __m256i u4_ = _mm256_unpacklo_epi64(t4_, t6_), u5_ = _mm256_unpackhi_epi64(t4_, t6_);              \
+    __m256i u6_ = _mm256_unpacklo_epi64(t5_, t7_), u7_ = _mm256_unpackhi_epi64(t5_, t7_);              \
+    r0 = _mm256_permute2x128_si256(u0_, u4_, 0x20); r4 = _mm256_permute2x128_si256(u0_, u4_, 0x31);    \
+    r1 = _mm256_permute2x128_si256(u1_, u5_, 0x20); r5 = _mm256_permute2x128_si256(u1_, u5_, 0x31);    \
+    r2 = _mm256_permute2x128_si256(u2_, u6_, 0x20); r6 = _mm256_permute2x128_si256(u2_, u6_, 0x31);    \
+    r3 = _mm256_permute2x128_si256(u3_, u7_, 0x20); r7 = _mm256_permute2x128_si256(u3_, u7_, 0x31);    \
+} while(0)
+
+static AVX2 UINT32 avx2_deinterleave_s32x8(void *dst, const void *src, UINT32 n) {
+    INT32 *p = dst;
+    const INT32 *in = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        const INT32 *f = in + 8 * i;
+        __m256i r0 = LD8(f),      r1 = LD8(f + 8),  r2 = LD8(f + 16), r3 = LD8(f + 24);
+        __m256i r4 = LD8(f + 32), r5 = LD8(f + 40), r6 = LD8(f + 48), r7 = LD8(f + 56);
+        TRANSPOSE8_EPI32(r0, r1, r2, r3, r4, r5, r6, r7);
+        ST8(p + i, r0);         ST8(p + n + i, r1);
+        ST8(p + 2 * n + i, r2); ST8(p + 3 * n + i, r3);
+        ST8(p + 4 * n + i, r4); ST8(p + 5 * n + i, r5);
+        ST8(p + 6 * n + i, r6); ST8(p + 7 * n + i, r7);
+    }
+    return i;
+}
+
+static AVX2 UINT32 avx2_interleave_s32x8(void *dst, const void *src, UINT32 n) {
+    INT32 *out = dst;
+    const INT32 *p = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256i r0 = LD8(p + i),         r1 = LD8(p + n + i);
+        __m256i r2 = LD8(p + 2 * n + i), r3 = LD8(p + 3 * n + i);
+        __m256i r4 = LD8(p + 4 * n + i), r5 = LD8(p + 5 * n + i);
+        __m256i r6 = LD8(p + 6 * n + i), r7 = LD8(p + 7 * n + i);
+        TRANSPOSE8_EPI32(r0, r1, r2, r3, r4, r5, r6, r7);
+        INT32 *f = out + 8 * i;
+        ST8(f, r0);      ST8(f + 8, r1);  ST8(f + 16, r2); ST8(f + 24, r3);
+        ST8(f + 32, r4); ST8(f + 40, r5); ST8(f + 48, r6); ST8(f + 56, r7);
+    }
+    return i;
+}
+#endif /*HAVE_X86_KERNELS*/
+
+#ifdef HAVE_NEON_KERNELS
+/*8 channels: vld4 leaves channels c and c + 4 alternating, vuzp splits them, vzip merges them back*/
+#define NEON_UZP_STORE_S32(c) do {                                      \
+    int32x4x2_t u_ = vuzpq_s32(a.val[c], b.val[c]);                     \
+    vst1q_s32(p + (c) * n + i, u_.val[0]);                              \
+    vst1q_s32(p + ((c) + 4) * n + i, u_.val[1]);                        \
+} while(0)
+#define NEON_ZIP_LOAD_S32(c) do {                                       \
+    int32x4x2_t z_ = vzipq_s32(vld1q_s32(p + (c) * n + i),              \
+                               vld1q_s32(p + ((c) + 4) * n + i));       \
+    a.val[c] = z_.val[0];                                               \
+    b.val[c] = z_.val[1];                                               \
+} while(0)
+#define NEON_UZP_STORE_S16(c) do {                                      \
+    int16x8x2_t u_ = vuzpq_s16(a.val[c], b.val[c]);                     \
+    vst1q_s16(p + (c) * n + i, u_.val[0]);                              \
+    vst1q_s16(p + ((c) + 4) * n + i, u_.val[1]);                        \
+} while(0)
+#define NEON_ZIP_LOAD_S16(c) do {                                       \
+    int16x8x2_t z_ = vzipq_s16(vld1q_s16(p + (c) * n + i),              \
+                               vld1q_s16(p + ((c) + 4) * n + i));       \
+    a.val[c] = z_.val[0];                                               \
+    b.val[c] = z_.val[1];                                               \
+} while(0)
+
+static UINT32 neon_deinterleave_s32x2(void *dst, const void *src, UINT32 n) {
+    INT32 *p = dst;
+    const INT32 *in = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        int32x4x2_t v = vld2q_s32(in + 2 * i);
+        vst1q_s32(p + i, v.val[0]);
+        vst1q_s32(p + n + i, v.val[1]);
+    }
+    return i;
+}
+
+static UINT32 neon_interleave_s32x2(void *dst, const void *src, UINT32 n) {
+    INT32 *out = dst;
+    const INT32 *p = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        int32x4x2_t v;
+        v.val[0] = vld1q_s32(p + i);
+        v.val[1] = vld1q_s32(p + n + i);
+        vst2q_s32(out + 2 * i, v);
+    }
+    return i;
+}
+
+static UINT32 neon_deinterleave_s32x4(void *dst, const void *src, UINT32 n) {
+    INT32 *p = dst;
+    const INT32 *in = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        int32x4x4_t v = vld4q_s32(in + 4 * i);
+        vst1q_s32(p + i, v.val[0]);
+        vst1q_s32(p + n + i, v.val[1]);
+        vst1q_s32(p + 2 * n + i, v.val[2]);
+        vst1q_s32(p + 3 * n + i, v.val[3]);
+    }
+    return i;
+}
+
+static UINT32 neon_interleave_s32x4(void *dst, const void *src, UINT32 n) {
+    INT32 *out = dst;
+    const INT32 *p = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        int32x4x4_t v;
+        v.val[0] = vld1q_s32(p + i);
+        v.val[1] = vld1q_s32(p + n + i);
+        v.val[2] = vld1q_s32(p + 2 * n + i);
+        v.val[3] = vld1q_s32(p + 3 * n + i);
+        vst4q_s32(out + 4 * i, v);
+    }
+    return i;
+}
+
+static UINT32 neon_deinterleave_s32x8(void *dst, const void *src, UINT32 n) {
+    INT32 *p = dst;
+    const INT32 *in = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        int32x4x4_t a = vld4q_s32(in + 8 * i);
+        int32x4x4_t b = vld4q_s32(in + 8 * i + 16);
+        NEON_UZP_STORE_S32(0);
+        NEON_UZP_STORE_S32(1);
+        NEON_UZP_STORE_S32(2);
+        NEON_UZP_STORE_S32(3);
+    }
+    return i;
+}
+
+static UINT32 neon_interleave_s32x8(void *dst, const void *src, UINT32 n) {
+    INT32 *out = dst;
+    const INT32 *p = src;
+    UINT32 i = 0;
+    for(; i + 4 <= n; i += 4) {
+        int32x4x4_t a, b;
+        NEON_ZIP_LOAD_S32(0);
+        NEON_ZIP_LOAD_S32(1);
+        NEON_ZIP_LOAD_S32(2);
+        NEON_ZIP_LOAD_S32(3);
+        vst4q_s32(out + 8 * i, a);
+        vst4q_s32(out + 8 * i + 16, b);
+    }
+    return i;
+}
+
+static UINT32 neon_deinterleave_s16x2(void *dst, const void *src, UINT32 n) {
+    INT16 *p = dst;
+    const INT16 *in = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        int16x8x2_t v = vld2q_s16(in + 2 * i);
+        vst1q_s16(p + i, v.val[0]);
+        vst1q_s16(p + n + i, v.val[1]);
+    }
+    return i;
+}
+
+static UINT32 neon_interleave_s16x2(void *dst, const void *src, UINT32 n) {
+    INT16 *out = dst;
+    const INT16 *p = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        int16x8x2_t v;
+        v.val[0] = vld1q_s16(p + i);
+        v.val[1] = vld1q_s16(p + n + i);
+        vst2q_s16(out + 2 * i, v);
+    }
+    return i;
+}
+
+static UINT32 neon_deinterleave_s16x4(void *dst, const void *src, UINT32 n) {
+    INT16 *p = dst;
+    const INT16 *in = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        int16x8x4_t v = vld4q_s16(in + 4 * i);
+        vst1q_s16(p + i, v.val[0]);
+        vst1q_s16(p + n + i, v.val[1]);
+        vst1q_s16(p + 2 * n + i, v.val[2]);
+        vst1q_s16(p + 3 * n + i, v.val[3]);
+    }
+    return i;
+}
+
+static UINT32 neon_interleave_s16x4(void *dst, const void *src, UINT32 n) {
+    INT16 *out = dst;
+    const INT16 *p = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        int16x8x4_t v;
+        v.val[0] = vld1q_s16(p + i);
+        v.val[1] = vld1q_s16(p + n + i);
+        v.val[2] = vld1q_s16(p + 2 * n + i);
+        v.val[3] = vld1q_s16(p + 3 * n + i);
+        vst4q_s16(out + 4 * i, v);
+    }
+    return i;
+}
+
+static UINT32 neon_deinterleave_s16x8(void *dst, const void *src, UINT32 n) {
+    INT16 *p = dst;
+    const INT16 *in = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        int16x8x4_t a = vld4q_s16(in + 8 * i);
+        int16x8x4_t b = vld4q_s16(in + 8 * i + 32);
+        NEON_UZP_STORE_S16(0);
+        NEON_UZP_STORE_S16(1);
+        NEON_UZP_STORE_S16(2);
+        NEON_UZP_STORE_S16(3);
+    }
+    return i;
+}
+
+static UINT32 neon_interleave_s16x8(void *dst, const void *src, UINT32 n) {
+    INT16 *out = dst;
+    const INT16 *p = src;
+    UINT32 i = 0;
+    for(; i + 8 <= n; i += 8) {
+        int16x8x4_t a, b;
+        NEON_ZIP_LOAD_S16(0);
+        NEON_ZIP_LOAD_S16(1);
+        NEON_ZIP_LOAD_S16(2);
+        NEON_ZIP_LOAD_S16(3);
+        vst4q_s16(out + 8 * i, a);
+        vst4q_s16(out + 8 * i + 32, b);
+    }
+    return i;
+}
+#endif /*HAVE_NEON_KERNELS*/
+
+static void set_kernel(int op, int w, int ch, Kernel_fn fn, const char *isa) {
+    kernels[op][w][ch] = fn;
+    kernel_isa[op][w][ch] = isa;
+}
+
+#define SET_ALL(isa, W, w, ch, n)                                                   \
+    set_kernel(OP_DEINTERLEAVE, W, ch, isa##_deinterleave_##w##x##n, #isa);         \
+    set_kernel(OP_INTERLEAVE, W, ch, isa##_interleave_##w##x##n, #isa)
+
+int interleave_init(const char *isa) {
+    int want_auto = isa == NULL || strcmp(isa, "auto") == 0;
+    memset(kernels, 0, sizeof(kernels));
+    for(int op = 0; op < OP_COUNT; op++)
+        for(int w = 0; w < W_COUNT; w++)
+            for(int ch = 0; ch < CH_COUNT; ch++)
+                kernel_isa[op][w][ch] = "scalar";
+
+    if(!want_auto && strcmp(isa, "scalar") == 0) {
+        active_isa = "scalar";
+        return 0;
+    }
+#ifdef HAVE_X86_KERNELS
+    int sse2 = want_auto || strcmp(isa, "sse2") == 0 || strcmp(isa, "avx2") == 0;
+    int avx2 = (want_auto || strcmp(isa, "avx2") == 0) && __builtin_cpu_supports("avx2");
+    if(!want_auto && strcmp(isa, "avx2") == 0 && !avx2) {
+        return -1;
+    }
+    if(sse2 && __builtin_cpu_supports("sse2")) {
+        SET_ALL(sse2, W_S32, s32, CH_2, 2);
+        SET_ALL(sse2, W_S32, s32, CH_4, 4);
+        SET_ALL(sse2, W_S32, s32, CH_8, 8);
+        SET_ALL(sse2, W_S16, s16, CH_2, 2);
+        SET_ALL(sse2, W_S16, s16, CH_4, 4);
+        SET_ALL(sse2, W_S16, s16, CH_8, 8);
+    }
+    if(avx2) {
+        SET_ALL(avx2, W_S32, s32, CH_2, 2);
+        SET_ALL(avx2, W_S32, s32, CH_4, 4);
+        SET_ALL(avx2, W_S32, s32, CH_8, 8);
+    }
+#endif
+#ifdef HAVE_NEON_KERNELS
+    if(want_auto || strcmp(isa, "neon") == 0) {
+        SET_ALL(neon, W_S32, s32, CH_2, 2);
+        SET_ALL(neon, W_S32, s32, CH_4, 4);
+        SET_ALL(neon, W_S32, s32, CH_8, 8);
+        SET_ALL(neon, W_S16, s16, CH_2, 2);
+        SET_ALL(neon, W_S16, s16, CH_4, 4);
+        SET_ALL(neon, W_S16, s16, CH_8, 8);
+    }
+#endif
+    active_isa = kernel_isa[OP_DEINTERLEAVE][W_S32][CH_2];
+    /*An explicit ISA this build or CPU can't run*/
+    if(!want_auto && strcmp(active_isa, isa) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+const char *interleave_isa(void) {
+    return active_isa;
+}
+
+static inline Kernel_fn pick(int op, int w, UINT32 channels) {
+    switch(channels) {
+    case 2: return kernels[op][w][CH_2];
+    case 4: return kernels[op][w][CH_4];
+    case 8: return kernels[op][w][CH_8];
+    default: return NULL;
+    }
+}
+
+void deinterleave_s32(INT32 *planar, const INT32 *interleaved, UINT32 channels, UINT32 frames) {
+    Kernel_fn fn = pick(OP_DEINTERLEAVE, W_S32, channels);
+    UINT32 done = fn ? fn(planar, interleaved, frames) : 0;
+    scalar_deinterleave_s32(planar, interleaved, channels, done, frames);
+}
+
+void interleave_s32(INT32 *interleaved, const INT32 *planar, UINT32 channels, UINT32 frames) {
+    Kernel_fn fn = pick(OP_INTERLEAVE, W_S32, channels);
+    UINT32 done = fn ? fn(interleaved, planar, frames) : 0;
+    scalar_interleave_s32(interleaved, planar, channels, done, frames);
+}
+
+void deinterleave_s16(INT16 *planar, const INT16 *interleaved, UINT32 channels, UINT32 frames) {
+    Kernel_fn fn = pick(OP_DEINTERLEAVE, W_S16, channels);
+    UINT32 done = fn ? fn(planar, interleaved, frames) : 0;
+    scalar_deinterleave_s16(planar, interleaved, channels, done, frames);
+}
+
+void interleave_s16(INT16 *interleaved, const INT16 *planar, UINT32 channels, UINT32 frames) {
+    Kernel_fn fn = pick(OP_INTERLEAVE, W_S16, channels);
+    UINT32 done = fn ? fn(interleaved, planar, frames) : 0;
+    scalar_interleave_s16(interleaved, planar, channels, done, frames);
+}
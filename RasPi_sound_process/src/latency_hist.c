@@ -0,0 +1,96 @@
+#include<stdio.h>
+#include<string.h>
+#include<time.h>
+#include"../inc/latency_hist.h"
+
+#define HIST_SUBS (1 << HIST_SUB_BITS)
+
+static inline unsigned bucket_of(UINT64 ns) {
+    if(ns < HIST_SUBS) {
+        return (unsigned)ns;
+    }
+    unsigned msb = 63 - __builtin_clzll(ns);
+    unsigned sub = (unsigned)(ns >> (msb - HIST_SUB_BITS)) & (HIST_SUBS - 1);
+    return ((msb - HIST_SUB_BITS + 1) << HIST_SUB_BITS) + sub;
+}
+
+static inline UINT64 bucket_top(unsigned b) {
+    if(b < HIST_SUBS) {
+        return b;
+    }
+    unsigned msb = (b >> HIST_SUB_BITS) + HIST_SUB_BITS - 1;
+    unsigned sub = b & (HIST_SUBS - 1);
+    UINT64 low = (UINT64)(HIST_SUBS + sub) << (msb - HIST_SUB_BITS);
+    return low + ((UINT64)1 << (msb - HIST_SUB_BITS)) - 1;
+}
+
+void hist_reset(Latency_hist_t *hist) {
+    for(int b = 0; b < HIST_BUCKETS; b++) {
+        atomic_store_explicit(&hist->count[b], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&hist->total, 0, memory_order_relaxed);
+    atomic_store_explicit(&hist->sum_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&hist->max_ns, 0, memory_order_relaxed);
+}
+
+void hist_record(Latency_hist_t *hist, UINT64 ns) {
+    atomic_fetch_add_explicit(&hist->count[bucket_of(ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->total, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->sum_ns, ns, memory_order_relaxed);
+    unsigned long long max = atomic_load_explicit(&hist->max_ns, memory_order_relaxed);
+    while(ns > max && !atomic_compare_exchange_weak_explicit(&hist->max_ns, &max, ns,
+                                                            memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void hist_record_single(Latency_hist_t *hist, UINT64 ns) {
+    atomic_uint *bucket = &hist->count[bucket_of(ns)];
+    atomic_store_explicit(bucket, atomic_load_explicit(bucket, memory_order_relaxed) + 1, memory_order_relaxed);
+    atomic_store_explicit(&hist->total, atomic_load_explicit(&hist->total, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_store_explicit(&hist->sum_ns, atomic_load_explicit(&hist->sum_ns, memory_order_relaxed) + ns,
+                          memory_order_relaxed);
+    if(ns > atomic_load_explicit(&hist->max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&hist->max_ns, ns, memory_order_relaxed);
+    }
+}
+
+UINT64 hist_percentile(const Latency_hist_t *hist, double p) {
+    UINT64 counts[HIST_BUCKETS], total = 0;
+    for(int b = 0; b < HIST_BUCKETS; b++) {
+        counts[b] = atomic_load_explicit(&hist->count[b], memory_order_relaxed);
+        total += counts[b];
+    }
+    if(total == 0) {
+        return 0;
+    }
+    /*Rank of the sample, 1-based, rounded up*/
+    UINT64 rank = (UINT64)(p / 100.0 * total + 0.999999);
+    if(rank == 0) {
+        rank = 1;
+    }
+    UINT64 seen = 0;
+    for(int b = 0; b < HIST_BUCKETS; b++) {
+        seen += counts[b];
+        if(seen >= rank) {
+            UINT64 top = bucket_top(b);
+            UINT64 max = atomic_load_explicit(&hist->max_ns, memory_order_relaxed);
+            return top < max ? top : max;
+        }
+    }
+    return atomic_load_explicit(&hist->max_ns, memory_order_relaxed);
+}
+
+int hist_format(const Latency_hist_t *hist, char *buf, size_t len) {
+    return snprintf(buf, len, "n %llu p50 %.1f p99 %.1f p99.9 %.1f max %.1f us",
+                    (unsigned long long)atomic_load_explicit(&hist->total, memory_order_relaxed),
+                    hist_percentile(hist, 50) / 1e3, hist_percentile(hist, 99) / 1e3,
+                    hist_percentile(hist, 99.9) / 1e3,
+                    atomic_load_explicit(&hist->max_ns, memory_order_relaxed) / 1e3);
+}
+
+UINT64 hist_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UINT64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
@@ -1,51 +1,265 @@
+#include<getopt.h>
 #include"../inc/sound_process.h"
 
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options] <input.pcm[:channels[@offset]]> ... <graph.awb>\n"
+                    "  each source feeds graph inputs offset.. (default: right after the previous one),\n"
+                    "  channels defaults to %d, at most %d sources\n"
+                    "  -q, --queue-depth N      blocks queued per source (%d..%d, default %d)\n"
+                    "  -H, --high-watermark N   reader pauses / playback starts at N blocks (default depth)\n"
+                    "  -L, --low-watermark N    reader resumes at N blocks (default depth / 2)\n"
+                    "  -i, --input-io MODE      stdio | mmap | uring | pread (default stdio)\n"
+                    "      --io-depth N         blocks in flight per source for uring/pread (default %d)\n"
+                    "      --io-threads N       pread worker threads, shared (default %d)\n"
+                    "  -l, --layout MODE        planar | interleaved source blocks (default planar)\n"
+                    "  -s, --simd ISA           auto | scalar | sse2 | avx2 | neon (default auto)\n"
+                    "  -S, --sink SINK          alsa | alsa-mmap | null | null-clocked | file:PATH (default alsa)\n"
+                    "                           null-clocked paces like a device with the pcm profile's buffer,\n"
+                    "                           null and file run faster than realtime and exit at the end\n"
+                    "  -a, --pcm-access MODE    rw | mmap, same as --sink alsa | alsa-mmap\n"
+                    "  -p, --pcm-profile NAME   safe | balanced | low-latency (default safe)\n"
+                    "  -P, --period-frames N    period size, a multiple or divisor of the block (default per profile)\n"
+                    "  -n, --periods N          periods per buffer (default per profile)\n"
+                    "      --xrun-policy NAME   restart | prefill | grow after an underrun (default restart),\n"
+                    "                           'xruns' on the socket lists the last ones\n"
+                    "  -r, --rt-policy POLICY   other | fifo | rr for the processing thread (default other)\n"
+                    "  -R, --rt-priority N      processing thread priority (default 80), AWE pumps run below it\n"
+                    "      --reader-priority N  run readers with the same policy at N (default normal)\n"
+                    "  -c, --cpus ROLE=LIST     pin process|reader|control|pump threads, e.g. process=3 pump=1-2\n"
+                    "  -m, --mlock              lock memory and prefault stacks/buffers\n"
+                    "  -o, --render FILE        same as --sink file:FILE (.wav, else raw S32_LE)\n"
+                    "  -t, --awe-threads N      AWE config.numThreads (default %d)\n"
+                    "  -x, --exit               exit once the sources ended, also with a clocked sink\n"
+                    "      --report FILE        append a run summary to FILE (.csv, else JSON lines)\n"
+                    "      --profile MS         sample AWE layout/module profiling every MS, 'profile' on the socket\n",
+            prog, SOURCE_CHANNELS, SOURCE_MAX, RING_MIN_DEPTH, RING_MAX_DEPTH, RING_DEPTH,
+            SOURCE_ASYNC_DEPTH, SOURCE_ASYNC_THREADS, AWE_DEFAULT_THREADS);
+}
+
+enum { OPT_READER_PRIORITY = 256, OPT_IO_DEPTH, OPT_IO_THREADS, OPT_REPORT, OPT_PROFILE, OPT_XRUN_POLICY };
+
+static int parse_options(int argc, char *argv[]) {
+    int reader_priority = 0;
+    UINT32 io_depth = 0, io_threads = 0;
+    static const struct option long_opts[] = {
+        {"queue-depth",    required_argument, NULL, 'q'},
+        {"high-watermark", required_argument, NULL, 'H'},
+        {"low-watermark",  required_argument, NULL, 'L'},
+        {"input-io",       required_argument, NULL, 'i'},
+        {"layout",         required_argument, NULL, 'l'},
+        {"simd",           required_argument, NULL, 's'},
+        {"sink",           required_argument, NULL, 'S'},
+        {"pcm-access",     required_argument, NULL, 'a'},
+        {"pcm-profile",    required_argument, NULL, 'p'},
+        {"period-frames",  required_argument, NULL, 'P'},
+        {"periods",        required_argument, NULL, 'n'},
+        {"rt-policy",      required_argument, NULL, 'r'},
+        {"rt-priority",    required_argument, NULL, 'R'},
+        {"reader-priority", required_argument, NULL, OPT_READER_PRIORITY},
+        {"io-depth",       required_argument, NULL, OPT_IO_DEPTH},
+        {"io-threads",     required_argument, NULL, OPT_IO_THREADS},
+        {"cpus",           required_argument, NULL, 'c'},
+        {"mlock",          no_argument,       NULL, 'm'},
+        {"render",         required_argument, NULL, 'o'},
+        {"awe-threads",    required_argument, NULL, 't'},
+        {"exit",           no_argument,       NULL, 'x'},
+        {"report",         required_argument, NULL, OPT_REPORT},
+        {"profile",        required_argument, NULL, OPT_PROFILE},
+        {"xrun-policy",    required_argument, NULL, OPT_XRUN_POLICY},
+        {"help",           no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "q:H:L:i:l:s:S:a:p:P:n:r:R:c:mo:t:xh", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case 'q': pipeline_cfg.queue_depth = strtoul(optarg, NULL, 0); break;
+        case 'H': pipeline_cfg.high_watermark = strtoul(optarg, NULL, 0); break;
+        case 'L': pipeline_cfg.low_watermark = strtoul(optarg, NULL, 0); break;
+        case 'P': pipeline_cfg.period_frames = strtoul(optarg, NULL, 0); break;
+        case 'n': pipeline_cfg.periods = strtoul(optarg, NULL, 0); break;
+        case 'R': rt_cfg.role[RT_ROLE_PROCESS].priority = atoi(optarg); break;
+        case OPT_READER_PRIORITY: reader_priority = atoi(optarg); break;
+        case OPT_IO_DEPTH: io_depth = strtoul(optarg, NULL, 0); break;
+        case OPT_IO_THREADS: io_threads = strtoul(optarg, NULL, 0); break;
+        case 'm': rt_cfg.lock_memory = 1; break;
+        case 't': pipeline_cfg.awe_threads = strtoul(optarg, NULL, 0); break;
+        case 'x': pipeline_cfg.exit_at_end = 1; break;
+        case OPT_REPORT: pipeline_cfg.report_path = optarg; break;
+        case OPT_PROFILE: pipeline_cfg.profile_ms = strtoul(optarg, NULL, 0); break;
+        case 'o':
+            pipeline_cfg.sink = SINK_FILE;
+            pipeline_cfg.sink_path = optarg;
+            break;
+        case 'S':
+            if (sink_parse(optarg, &pipeline_cfg.sink, &pipeline_cfg.sink_path) != 0) {
+                fprintf(stderr, "Unknown sink: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'r':
+            if (rt_parse_policy(optarg, &rt_cfg.role[RT_ROLE_PROCESS].policy) != 0) {
+                fprintf(stderr, "Unknown scheduling policy: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'c':
+            if (rt_parse_affinity(optarg) != 0) {
+                fprintf(stderr, "Bad cpu spec: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'i':
+            if (pcm_source_parse_io(optarg, &pipeline_cfg.input_io) != 0) {
+                fprintf(stderr, "Unknown input io mode: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'l':
+            if (strcmp(optarg, "planar") == 0) {
+                pipeline_cfg.layout = LAYOUT_PLANAR;
+            } else if (strcmp(optarg, "interleaved") == 0) {
+                pipeline_cfg.layout = LAYOUT_INTERLEAVED;
+            } else {
+                fprintf(stderr, "Unknown layout: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 's':
+            if (interleave_init(optarg) != 0) {
+                fprintf(stderr, "SIMD kernels %s not available\n", optarg);
+                return -1;
+            }
+            break;
+        case 'a':
+            if (strcmp(optarg, "rw") == 0) {
+                pipeline_cfg.sink = SINK_ALSA;
+            } else if (strcmp(optarg, "mmap") == 0) {
+                pipeline_cfg.sink = SINK_ALSA_MMAP;
+            } else {
+                fprintf(stderr, "Unknown pcm access: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'p':
+            if (pcm_parse_profile(optarg, &pipeline_cfg.pcm_profile) != 0) {
+                fprintf(stderr, "Unknown pcm profile: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case OPT_XRUN_POLICY:
+            if (xrun_parse_policy(optarg, &pipeline_cfg.xrun_policy) != 0) {
+                fprintf(stderr, "Unknown xrun policy: %s\n", optarg);
+                return -1;
+            }
+            break;
+        default: return -1;
+        }
+    }
+    if (pipeline_cfg.awe_threads < 1 || pipeline_cfg.awe_threads > 31) {
+        fprintf(stderr, "awe-threads must be 1..31\n");
+        return -1;
+    }
+    pcm_source_set_async(io_depth, io_threads);
+    Rt_role_cfg_t *process = &rt_cfg.role[RT_ROLE_PROCESS];
+    if (process->priority == 0) {
+        process->priority = 80;
+    }
+    if (reader_priority > 0 && process->policy != SCHED_OTHER) {
+        rt_cfg.role[RT_ROLE_READER].policy = process->policy;
+        rt_cfg.role[RT_ROLE_READER].priority = reader_priority;
+    }
+    return argc - optind < 2 ? -1 : optind;
+}
+
 int main(int argc, char *argv[]) {
-    if (argc < 4) {
-        fprintf(stderr, "Usage: %s <input1.pcm> <input2.pcm> <graph.awb>\n", argv[0]);
+    interleave_init(NULL);
+    int arg = parse_options(argc, argv);
+    if (arg < 0) {
+        usage(argv[0]);
         return 1;
     }
-    init_aweCoreOS(argv[3]);
-
-    PCM_device_t pcm_dev;
-    if (init_pcm(&pcm_dev) != 0) {
+    argv += arg;
+    const int num_files = argc - arg - 1;
+    const char *graph = argv[num_files];
+    printf("Interleave kernels: %s\n", interleave_isa());
+    /*Before anything maps the input files, pcm_source unlocks those again*/
+    rt_log_config();
+    if (rt_lock_memory() != 0) {
+        fprintf(stderr, "Continuing without locked memory\n");
+    }
+    if (init_aweCoreOS(graph) != 0 || init_buffers() != 0) {
         return 1;
     }
 
-    Read_file_t read1 = {argv[1], 0};
-    Read_file_t read2 = {argv[2], 2};
-
-    pthread_t thread1, thread2, thread3;
-    pthread_create(&thread1, NULL, read_thread, &read1);
-    pthread_create(&thread2, NULL, read_thread, &read2);
-    pthread_create(&thread3, NULL, sound_processing, &pcm_dev);
+    Audio_sink_t sink;
+    if (sink_open(&sink, pipeline_cfg.sink, pipeline_cfg.sink_path) != 0) {
+        return 1;
+    }
+    if (control_queue_init() != 0 || control_registry_init() != 0) {
+        return 1;
+    }
+    if (sink_is_clocked(sink.type)) {
+        xrun_register_callback(xrun_log_callback, NULL, XRUN_NOTIFY_ALL);
+        xrun_start();
+    }
 
-    int server_fd;
-    int client_fd;
-    int len;
-    struct sockaddr_in client_addr;
-    memset(&client_addr, 0, sizeof(client_addr));
+    Read_file_t *readers = calloc(num_files, sizeof(Read_file_t));
+    pthread_t *reader_threads = calloc(num_files, sizeof(pthread_t));
+    if (!readers || !reader_threads) {
+        return 1;
+    }
+    for (int s = 0; s < num_files; s++) {
+        if (parse_source(argv[s], &readers[s]) != 0) {
+            fprintf(stderr, "Bad source: %s\n", argv[s]);
+            return 1;
+        }
+    }
+    if (init_sources(readers, num_files) != 0) {
+        return 1;
+    }
 
-    init_TCPSocket(&server_fd);
-    len = sizeof(client_addr);
+    if (pipeline_cfg.profile_ms) {
+        Profile_clock_t clock = { geom.core_speed, geom.profile_speed, geom.block_ns };
+        profiler_start(awe, &clock, pipeline_cfg.profile_ms);
+    }
 
-    while (1) {
-        printf("Server is listening at port: %d \n..............\n", TCP_PORT_NO);
-        client_fd = accept(server_fd, (struct sockaddr*)&client_addr, (socklen_t *)&len);
-        if(client_fd == -1) 
-            fprintf(stderr, "Failed accept()\n", strerror(-1));
-        
-        system("clear");
+    pthread_t process_thread;
+    for (int s = 0; s < num_files; s++) {
+        pthread_create(&reader_threads[s], NULL, read_thread, &readers[s]);
+    }
+    pthread_create(&process_thread, NULL, sound_processing, &sink);
+    if (!sink_is_clocked(sink.type) || pipeline_cfg.exit_at_end) {
+        void *failed;
+        pthread_join(process_thread, &failed);
+        xrun_stop();
+        sink_close(&sink);
+        if (failed) {
+            return 1;   /*readers may be stuck on full rings*/
+        }
+        for (int s = 0; s < num_files; s++) {
+            pthread_join(reader_threads[s], NULL);
+        }
+        profiler_stop();
+        aweOS_destroy(&awe);
+        return 0;
+    }
+    rt_enter(RT_ROLE_CONTROL);
 
-        printf("Server: got connection\n");
-        socket_chat(client_fd);
+    int server_fd = -1;
+    if (init_TCPSocket(&server_fd) != 0 || control_server_run(server_fd) != 0) {
+        fprintf(stderr, "Control server stopped, playing on\n");
     }
 
-    pthread_join(thread1, NULL);
-    pthread_join(thread2, NULL);
-    pthread_join(thread3, NULL);
+    for (int s = 0; s < num_files; s++) {
+        pthread_join(reader_threads[s], NULL);
+    }
+    pthread_join(process_thread, NULL);
+    profiler_stop();
+    xrun_stop();
     aweOS_destroy(&awe);
-    snd_pcm_close(pcm_dev.dev);
-    close(server_fd);
+    sink_close(&sink);
+    if (server_fd >= 0) {
+        close(server_fd);
+    }
     return 0;
 }
\ No newline at end of file
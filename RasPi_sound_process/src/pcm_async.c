@@ -0,0 +1,419 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<errno.h>
+#include<pthread.h>
+#include<unistd.h>
+#include<stdint.h>
+#include<stdatomic.h>
+#include<sys/stat.h>
+#include<sys/uio.h>
+#include<sys/mman.h>
+#include<sys/syscall.h>
+#include"../inc/pcm_async.h"
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include<linux/io_uring.h>
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+enum { SLOT_FREE, SLOT_INFLIGHT, SLOT_DONE };
+
+typedef struct Async_slot {
+    unsigned char *buf;
+    struct iovec iov;         //io_uring READV, must outlive the request on old kernels
+    off_t offset;
+    UINT64 submit_ns;
+    ssize_t res;
+    atomic_int state;
+    int fd;
+    size_t len;
+    Latency_hist_t *lat;
+    struct Async_slot *next;  //pool queue link
+} Async_slot_t;
+
+#ifdef HAVE_IO_URING
+typedef struct {
+    int fd;
+    unsigned *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_map, *cq_map;
+    size_t sq_len, cq_len, sqe_len;
+} Uring_t;
+#endif
+
+struct Pcm_async {
+    int uring;
+    int fd;
+    size_t block_bytes;
+    UINT32 depth;
+    off_t file_len;
+    off_t next_offset;
+    UINT32 submitted;  //blocks handed to the engine
+    UINT32 consumed;   //blocks handed out, slot = consumed % depth
+    Async_slot_t *slots;
+    unsigned char *bufs;
+    Latency_hist_t *lat;
+    atomic_ulong *stalls;
+#ifdef HAVE_IO_URING
+    Uring_t ring;
+#endif
+};
+
+/*
+ * pread pool shared by all sources. The queue is only touched under the
+ * lock; a finished slot is published through its atomic state.
+ */
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    Async_slot_t *head, *tail;
+    UINT32 threads;
+} pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, 0 };
+
+static ssize_t pread_full(int fd, unsigned char *buf, size_t len, off_t offset) {
+    size_t done = 0;
+    while(done < len) {
+        ssize_t n = pread(fd, buf + done, len - done, offset + done);
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+        if(n < 0) {
+            return -errno;
+        }
+        if(n == 0) {
+            break;
+        }
+        done += n;
+    }
+    return (ssize_t)done;
+}
+
+static void *pool_worker(void *arg) {
+    (void)arg;
+    while(1) {
+        pthread_mutex_lock(&pool.lock);
+        while(!pool.head) {
+            pthread_cond_wait(&pool.work, &pool.lock);
+        }
+        Async_slot_t *slot = pool.head;
+        pool.head = slot->next;
+        if(!pool.head) {
+            pool.tail = NULL;
+        }
+        pthread_mutex_unlock(&pool.lock);
+
+        slot->res = pread_full(slot->fd, slot->buf, slot->len, slot->offset);
+        hist_record(slot->lat, hist_now_ns() - slot->submit_ns);
+
+        pthread_mutex_lock(&pool.lock);
+        atomic_store_explicit(&slot->state, SLOT_DONE, memory_order_release);
+        pthread_cond_broadcast(&pool.done);
+        pthread_mutex_unlock(&pool.lock);
+    }
+    return NULL;
+}
+
+/*Workers are started once, the first caller decides how many*/
+static int pool_start(UINT32 threads) {
+    pthread_mutex_lock(&pool.lock);
+    for(; pool.threads < threads; pool.threads++) {
+        pthread_t tid;
+        if(pthread_create(&tid, NULL, pool_worker, NULL) != 0) {
+            break;
+        }
+        pthread_detach(tid);
+    }
+    int ok = pool.threads > 0;
+    pthread_mutex_unlock(&pool.lock);
+    return ok ? 0 : -1;
+}
+
+static void pool_submit(Async_slot_t *slot) {
+    pthread_mutex_lock(&pool.lock);
+    slot->next = NULL;
+    if(pool.tail) {
+        pool.tail->next = slot;
+    } else {
+        pool.head = slot;
+    }
+    pool.tail = slot;
+    pthread_cond_signal(&pool.work);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+static void pool_wait(Async_slot_t *slot) {
+    pthread_mutex_lock(&pool.lock);
+    while(atomic_load_explicit(&slot->state, memory_order_acquire) != SLOT_DONE) {
+        pthread_cond_wait(&pool.done, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+}
+
+#ifdef HAVE_IO_URING
+static int uring_init(Uring_t *r, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+    r->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if(r->fd < 0) {
+        return -1;
+    }
+    r->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    int single = 0;
+#ifdef IORING_FEAT_SINGLE_MMAP
+    if(p.features & IORING_FEAT_SINGLE_MMAP) {
+        single = 1;
+        if(r->cq_len > r->sq_len) {
+            r->sq_len = r->cq_len;
+        }
+    }
+#endif
+    r->sq_map = mmap(NULL, r->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    if(r->sq_map == MAP_FAILED) {
+        close(r->fd);
+        return -1;
+    }
+    r->cq_map = r->sq_map;
+    if(!single) {
+        r->cq_map = mmap(NULL, r->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+        if(r->cq_map == MAP_FAILED) {
+            munmap(r->sq_map, r->sq_len);
+            close(r->fd);
+            return -1;
+        }
+    }
+    r->sqe_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqe_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+    if(r->sqes == MAP_FAILED) {
+        if(!single) {
+            munmap(r->cq_map, r->cq_len);
+        }
+        munmap(r->sq_map, r->sq_len);
+        close(r->fd);
+        return -1;
+    }
+    char *sq = r->sq_map, *cq = r->cq_map;
+    r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+static void uring_free(Uring_t *r) {
+    munmap(r->sqes, r->sqe_len);
+    if(r->cq_map != r->sq_map) {
+        munmap(r->cq_map, r->cq_len);
+    }
+    munmap(r->sq_map, r->sq_len);
+    close(r->fd);
+}
+
+static int uring_submit(Pcm_async_t *a, UINT32 index) {
+    Uring_t *r = &a->ring;
+    Async_slot_t *slot = &a->slots[index];
+    unsigned tail = *r->sq_tail;   /*only we write it*/
+    unsigned idx = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+
+    memset(sqe, 0, sizeof(*sqe));
+    slot->iov.iov_base = slot->buf;
+    slot->iov.iov_len = slot->len;
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = a->fd;
+    sqe->off = slot->offset;
+    sqe->addr = (unsigned long)&slot->iov;
+    sqe->len = 1;
+    sqe->user_data = index;
+    r->sq_array[idx] = idx;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    while(syscall(__NR_io_uring_enter, r->fd, 1, 0, 0, NULL, 0) < 0) {
+        if(errno != EINTR && errno != EAGAIN) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Move completions into their slots. Latency is taken when the completion
+ * is seen, so while the reader runs ahead it is an upper bound; when the
+ * reader waits it is exact, which is the case that matters.
+ */
+static int uring_reap(Pcm_async_t *a, int wait) {
+    Uring_t *r = &a->ring;
+    unsigned head = *r->cq_head;
+    unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+    if(head == tail && wait) {
+        if(syscall(__NR_io_uring_enter, r->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR) {
+            return -1;
+        }
+        tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+    }
+    UINT64 now = hist_now_ns();
+    for(; head != tail; head++) {
+        struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+        Async_slot_t *slot = &a->slots[cqe->user_data];
+        slot->res = cqe->res;
+        hist_record(a->lat, now - slot->submit_ns);
+        atomic_store_explicit(&slot->state, SLOT_DONE, memory_order_relaxed);
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+    return 0;
+}
+#endif
+
+/*Keep depth blocks in flight, only whole blocks are read*/
+static int refill(Pcm_async_t *a) {
+    while(a->submitted - a->consumed < a->depth &&
+          a->next_offset + (off_t)a->block_bytes <= a->file_len) {
+        UINT32 index = a->submitted % a->depth;
+        Async_slot_t *slot = &a->slots[index];
+        slot->offset = a->next_offset;
+        slot->submit_ns = hist_now_ns();
+        atomic_store_explicit(&slot->state, SLOT_INFLIGHT, memory_order_relaxed);
+#ifdef HAVE_IO_URING
+        if(a->uring) {
+            if(uring_submit(a, index) != 0) {
+                atomic_store_explicit(&slot->state, SLOT_FREE, memory_order_relaxed);
+                return -1;
+            }
+        } else
+#endif
+        {
+            pool_submit(slot);
+        }
+        a->next_offset += a->block_bytes;
+        a->submitted++;
+    }
+    return 0;
+}
+
+static int wait_slot(Pcm_async_t *a, Async_slot_t *slot) {
+    if(atomic_load_explicit(&slot->state, memory_order_acquire) == SLOT_DONE) {
+        return 0;
+    }
+#ifdef HAVE_IO_URING
+    if(a->uring) {
+        uring_reap(a, 0);
+        if(atomic_load_explicit(&slot->state, memory_order_relaxed) == SLOT_DONE) {
+            return 0;
+        }
+        atomic_fetch_add_explicit(a->stalls, 1, memory_order_relaxed);
+        while(atomic_load_explicit(&slot->state, memory_order_relaxed) != SLOT_DONE) {
+            if(uring_reap(a, 1) != 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+#endif
+    atomic_fetch_add_explicit(a->stalls, 1, memory_order_relaxed);
+    pool_wait(slot);
+    return 0;
+}
+
+Pcm_async_t *pcm_async_open(int fd, int want_uring, size_t block_bytes, UINT32 depth,
+                            UINT32 pool_threads, Latency_hist_t *lat, atomic_ulong *stalls) {
+    struct stat st;
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || depth == 0) {
+        return NULL;
+    }
+    Pcm_async_t *a = calloc(1, sizeof(*a));
+    if(!a) {
+        return NULL;
+    }
+    a->fd = fd;
+    a->block_bytes = block_bytes;
+    a->depth = depth;
+    a->file_len = st.st_size;
+    a->lat = lat;
+    a->stalls = stalls;
+    a->slots = calloc(depth, sizeof(Async_slot_t));
+    if(!a->slots || posix_memalign((void **)&a->bufs, 4096, block_bytes * depth) != 0) {
+        free(a->slots);
+        free(a);
+        return NULL;
+    }
+    for(UINT32 i = 0; i < depth; i++) {
+        a->slots[i].buf = a->bufs + i * block_bytes;
+        a->slots[i].fd = fd;
+        a->slots[i].len = block_bytes;
+        a->slots[i].lat = lat;
+    }
+#ifdef HAVE_IO_URING
+    if(want_uring) {
+        a->uring = uring_init(&a->ring, depth) == 0;
+        if(!a->uring) {
+            fprintf(stderr, "io_uring unavailable (%s), using pread workers\n", strerror(errno));
+        }
+    }
+#else
+    if(want_uring) {
+        fprintf(stderr, "built without io_uring, using pread workers\n");
+    }
+#endif
+    if(!a->uring && pool_start(pool_threads ? pool_threads : 1) != 0) {
+        free(a->bufs);
+        free(a->slots);
+        free(a);
+        return NULL;
+    }
+    if(refill(a) != 0) {
+        pcm_async_close(a);
+        return NULL;
+    }
+    return a;
+}
+
+int pcm_async_is_uring(const Pcm_async_t *a) {
+    return a->uring;
+}
+
+int pcm_async_next(Pcm_async_t *a, void *dst) {
+    if(a->consumed == a->submitted) {
+        return 0;
+    }
+    Async_slot_t *slot = &a->slots[a->consumed % a->depth];
+    if(wait_slot(a, slot) != 0) {
+        return -1;
+    }
+    ssize_t res = slot->res;
+    if(res == (ssize_t)a->block_bytes) {
+        memcpy(dst, slot->buf, a->block_bytes);
+    }
+    atomic_store_explicit(&slot->state, SLOT_FREE, memory_order_relaxed);
+    a->consumed++;
+    if(res != (ssize_t)a->block_bytes) {
+        if(res < 0) {
+            fprintf(stderr, "async read at %lld: %s\n", (long long)slot->offset, strerror((int)-res));
+        }
+        return res < 0 ? -1 : 0;
+    }
+    return refill(a) == 0 ? 1 : -1;
+}
+
+void pcm_async_close(Pcm_async_t *a) {
+    /*Buffers can't go while the kernel or a worker still writes them*/
+    for(; a->consumed != a->submitted; a->consumed++) {
+        wait_slot(a, &a->slots[a->consumed % a->depth]);
+    }
+#ifdef HAVE_IO_URING
+    if(a->uring) {
+        uring_free(&a->ring);
+    }
+#endif
+    free(a->bufs);
+    free(a->slots);
+    free(a);
+}
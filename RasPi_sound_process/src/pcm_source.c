@@ -0,0 +1,181 @@
+#include<string.h>
+#include<errno.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include"../inc/pcm_source.h"
+
+/*Read-ahead window kept resident in front of the reader in mmap mode*/
+#define SOURCE_READAHEAD_BYTES (2u << 20)
+
+static const char *io_names[] = {
+    [SOURCE_IO_STDIO] = "stdio",
+    [SOURCE_IO_MMAP]  = "mmap",
+    [SOURCE_IO_URING] = "uring",
+    [SOURCE_IO_PREAD] = "pread",
+};
+
+static UINT32 async_depth = SOURCE_ASYNC_DEPTH;
+static UINT32 async_threads = SOURCE_ASYNC_THREADS;
+
+void pcm_source_set_async(UINT32 depth, UINT32 threads) {
+    if(depth) {
+        async_depth = depth;
+    }
+    if(threads) {
+        async_threads = threads;
+    }
+}
+
+int pcm_source_parse_io(const char *name, Source_io_t *io) {
+    for(size_t i = 0; i < sizeof(io_names) / sizeof(io_names[0]); i++) {
+        if(strcmp(name, io_names[i]) == 0) {
+            *io = (Source_io_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *pcm_source_io_name(Source_io_t io) {
+    return io_names[io];
+}
+
+static int open_mmap(Pcm_source_t *src, const char *path) {
+    struct stat st;
+    FILE *fp = fopen(path, "rb");
+    if(!fp) {
+        return -1;
+    }
+    if(fstat(fileno(fp), &st) != 0 || st.st_size == 0 || (unsigned long long)st.st_size > (size_t)-1) {
+        fclose(fp);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    if(map == MAP_FAILED) {
+        fprintf(stderr, "mmap %s: %s\n", path, strerror(errno));
+        fclose(fp);
+        return -1;
+    }
+    /*Never part of mlockall, or the whole file would stay resident and DONTNEED fails*/
+    munlock(map, (size_t)st.st_size);
+    /*Kernel read-ahead for a linear scan, and start paging in the first window*/
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    src->advised = (size_t)st.st_size < SOURCE_READAHEAD_BYTES ? (size_t)st.st_size : SOURCE_READAHEAD_BYTES;
+    madvise(map, src->advised, MADV_WILLNEED);
+    src->fp = fp;
+    src->map = map;
+    src->map_len = (size_t)st.st_size;
+    return 0;
+}
+
+int pcm_source_open(Pcm_source_t *src, const char *path, Source_io_t io, size_t frame_bytes) {
+    memset(src, 0, sizeof(*src));
+    src->frame_bytes = frame_bytes;
+    src->page = (size_t)sysconf(_SC_PAGESIZE);
+    src->io = io;
+    if(io == SOURCE_IO_MMAP) {
+        if(open_mmap(src, path) == 0) {
+            return 0;
+        }
+        fprintf(stderr, "%s: can't map, falling back to stdio\n", path);
+        src->io = SOURCE_IO_STDIO;
+    }
+    src->fp = fopen(path, "rb");
+    return src->fp ? 0 : -1;
+}
+
+/*The block size is only known at the first read; fp then just owns the descriptor*/
+static void open_async(Pcm_source_t *src, size_t block_bytes) {
+    src->async = pcm_async_open(fileno(src->fp), src->io == SOURCE_IO_URING, block_bytes,
+                                async_depth, async_threads, &src->read_lat, &src->stalls);
+    if(!src->async) {
+        fprintf(stderr, "async reads unavailable, falling back to stdio\n");
+        src->io = SOURCE_IO_STDIO;
+    } else if(src->io == SOURCE_IO_URING && !pcm_async_is_uring(src->async)) {
+        src->io = SOURCE_IO_PREAD;
+    }
+}
+
+/*Keep a window of pages in flight ahead of pos and drop what's behind keep*/
+static void advise_window(Pcm_source_t *src, size_t keep) {
+    size_t page = src->page;
+    if(src->pos + SOURCE_READAHEAD_BYTES / 2 > src->advised && src->advised < src->map_len) {
+        size_t len = src->map_len - src->advised;
+        if(len > SOURCE_READAHEAD_BYTES) {
+            len = SOURCE_READAHEAD_BYTES;
+        }
+        size_t start = src->advised & ~(page - 1);
+        madvise((void *)(src->map + start), src->advised + len - start, MADV_WILLNEED);
+        src->advised += len;
+    }
+    /*Only unmaps our view, the page cache still holds the data*/
+    if(keep < src->lag) {
+        return;
+    }
+    size_t behind = (keep - src->lag) & ~(page - 1);
+    if(behind >= src->dropped + SOURCE_READAHEAD_BYTES) {
+        madvise((void *)(src->map + src->dropped), behind - src->dropped, MADV_DONTNEED);
+        src->dropped = behind;
+    }
+}
+
+/*Take the page faults here rather than on whoever reads the block later*/
+static void prefault(const unsigned char *p, size_t bytes, size_t page) {
+    for(size_t off = 0; off < bytes; off += page) {
+        (void)*(volatile const unsigned char *)(p + off);
+    }
+    (void)*(volatile const unsigned char *)(p + bytes - 1);
+}
+
+const void *pcm_source_next(Pcm_source_t *src, void *scratch, UINT32 frames) {
+    size_t bytes = src->frame_bytes * frames;
+    if(src->io == SOURCE_IO_MMAP) {
+        if(src->map_len - src->pos < bytes) {
+            return NULL;
+        }
+        const void *block = src->map + src->pos;
+        src->pos += bytes;
+        advise_window(src, src->pos - bytes);
+        UINT64 t0 = hist_now_ns();
+        prefault(block, bytes, src->page);
+        hist_record(&src->read_lat, hist_now_ns() - t0);
+        return block;
+    }
+    if((src->io == SOURCE_IO_URING || src->io == SOURCE_IO_PREAD) && !src->async) {
+        open_async(src, bytes);
+    }
+    if(src->async) {
+        if(pcm_async_next(src->async, scratch) != 1) {
+            return NULL;
+        }
+        src->pos += bytes;
+        return scratch;
+    }
+    UINT64 t0 = hist_now_ns();
+    if(fread(scratch, src->frame_bytes, frames, src->fp) != frames) {
+        return NULL;
+    }
+    hist_record(&src->read_lat, hist_now_ns() - t0);
+    src->pos += bytes;
+    return scratch;
+}
+
+unsigned long pcm_source_stalls(const Pcm_source_t *src) {
+    return atomic_load_explicit(&src->stalls, memory_order_relaxed);
+}
+
+void pcm_source_close(Pcm_source_t *src) {
+    if(src->async) {
+        pcm_async_close(src->async);
+        src->async = NULL;
+    }
+    if(src->map) {
+        munmap((void *)src->map, src->map_len);
+        src->map = NULL;
+    }
+    if(src->fp) {
+        fclose(src->fp);
+        src->fp = NULL;
+    }
+}
@@ -0,0 +1,133 @@
+#include<stdio.h>
+#include<string.h>
+#include<time.h>
+#include<pthread.h>
+#include<stdatomic.h>
+#include"../inc/profiler.h"
+#include"../inc/rt_sched.h"
+#include"../inc/control_registry.h"
+
+/*Raw 24.8 profileSpeed ticks, last sample and peak*/
+typedef struct {
+    UINT32 last;
+    UINT32 peak;
+    int valid;
+} Profile_value_t;
+
+static struct {
+    AWEOSInstance *awe;
+    Profile_clock_t clock;
+    UINT32 period_ms;
+    pthread_t thread;
+    atomic_int running;
+    pthread_mutex_t lock; //samples, between the sampler and format_profile
+    Profile_value_t layout;
+    const Control_object_t *profile_time[PROFILE_MAX_MODULES]; //every module's profileTime in the registry
+    size_t modules;
+    Profile_value_t module[PROFILE_MAX_MODULES];
+    unsigned long samples;
+} prof = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static void update(Profile_value_t *v, UINT32 raw) {
+    v->last = raw;
+    if(!v->valid || raw > v->peak) {
+        v->peak = raw;
+    }
+    v->valid = 1;
+}
+
+static void *profile_thread(void *arg) {
+    (void)arg;
+    rt_enter(RT_ROLE_CONTROL);
+    struct timespec period = { prof.period_ms / 1000, (long)(prof.period_ms % 1000) * 1000000L };
+    while(atomic_load(&prof.running)) {
+        nanosleep(&period, NULL);
+        UINT32 layout, module[PROFILE_MAX_MODULES];
+        int layout_ok = aweOS_getAverageLayoutCycles(prof.awe, 0, &layout) == E_SUCCESS;
+        int module_ok[PROFILE_MAX_MODULES];
+        for(size_t m = 0; m < prof.modules; m++) {
+            INT32 raw = 0;
+            module_ok[m] = aweOS_ctrlGetValue(prof.awe, prof.profile_time[m]->handle, &raw, 0, 1) == E_SUCCESS;
+            module[m] = (UINT32)raw;
+        }
+        pthread_mutex_lock(&prof.lock);
+        if(layout_ok) {
+            update(&prof.layout, layout);
+        }
+        for(size_t m = 0; m < prof.modules; m++) {
+            if(module_ok[m]) {
+                update(&prof.module[m], module[m]);
+            }
+        }
+        prof.samples++;
+        pthread_mutex_unlock(&prof.lock);
+    }
+    return NULL;
+}
+
+int profiler_start(AWEOSInstance *instance, const Profile_clock_t *clock, UINT32 period_ms) {
+    INT32 ret = aweOS_setProfilingStatus(instance, 1);
+    if(ret != E_SUCCESS) {
+        fprintf(stderr, "aweOS_setProfilingStatus: %s\n", aweOS_errorToString(ret));
+        return -1;
+    }
+    prof.awe = instance;
+    prof.clock = *clock;
+    prof.modules = 0;
+    for(UINT32 i = 0; i < control_object_count && prof.modules < PROFILE_MAX_MODULES; i++) {
+        const char *param = strchr(control_objects[i].name, '.');
+        if(param && strcmp(param + 1, "profileTime") == 0) {
+            prof.profile_time[prof.modules++] = &control_objects[i];
+        }
+    }
+    prof.period_ms = period_ms ? period_ms : PROFILE_DEFAULT_MS;
+    atomic_store(&prof.running, 1);
+    if(pthread_create(&prof.thread, NULL, profile_thread, NULL) != 0) {
+        atomic_store(&prof.running, 0);
+        return -1;
+    }
+    printf("Profiling every %u ms, core %.0f MHz, profile clock %.1f MHz\n", prof.period_ms,
+           prof.clock.core_speed / 1e6, prof.clock.profile_speed / 1e6);
+    return 0;
+}
+
+void profiler_stop(void) {
+    if(atomic_exchange(&prof.running, 0)) {
+        pthread_join(prof.thread, NULL);
+    }
+}
+
+int profiler_running(void) {
+    return atomic_load(&prof.running);
+}
+
+static int format_value(char *buf, size_t len, const char *name, const Profile_value_t *v) {
+    if(!v->valid) {
+        return snprintf(buf, len, "%-12s n/a\n", name);
+    }
+    const double ticks_per_us = prof.clock.profile_speed / 1e6;
+    const double block_us = prof.clock.block_ns / 1e3;
+    const double us = v->last / 256.0 / ticks_per_us, peak_us = v->peak / 256.0 / ticks_per_us;
+    return snprintf(buf, len, "%-12s %10.0f cycles %9.1f us %5.1f%%, peak %9.1f us %5.1f%%\n", name,
+                    us * prof.clock.core_speed / 1e6, us, 100.0 * us / block_us,
+                    peak_us, 100.0 * peak_us / block_us);
+}
+
+int format_profile(char *buf, size_t len) {
+    if(!profiler_running()) {
+        return snprintf(buf, len, "profiling off, start with --profile MS\n");
+    }
+    int n;
+    char name[32];
+    pthread_mutex_lock(&prof.lock);
+    n = snprintf(buf, len, "profile: %lu samples, block %.1f us\n", prof.samples, prof.clock.block_ns / 1e3);
+    if(n < (int)len) {
+        n += format_value(buf + n, len - n, "layout 0", &prof.layout);
+    }
+    for(size_t m = 0; m < prof.modules && n < (int)len; m++) {
+        snprintf(name, sizeof(name), "%s/%u", prof.profile_time[m]->module, prof.profile_time[m]->object_id);
+        n += format_value(buf + n, len - n, name, &prof.module[m]);
+    }
+    pthread_mutex_unlock(&prof.lock);
+    return n;
+}
@@ -0,0 +1,57 @@
+#include<string.h>
+#include<strings.h>
+#include"AWECoreOS.h"
+#include"../inc/render.h"
+
+static int is_wav(const char *path) {
+    size_t len = strlen(path);
+    return len > 4 && strcasecmp(path + len - 4, ".wav") == 0;
+}
+
+int render_open(Render_file_t *r, const char *path, UINT32 channels, UINT32 sample_rate) {
+    memset(r, 0, sizeof(*r));
+    r->channels = channels;
+    r->wav = is_wav(path);
+    if(r->wav) {
+        INT32 ret = aweOS_wavFileCreate(path, (FLOAT32)sample_rate, channels, sizeof(INT32), &r->fp);
+        if(ret != E_SUCCESS) {
+            fprintf(stderr, "aweOS_wavFileCreate %s: %s\n", path, aweOS_errorToString(ret));
+            return -1;
+        }
+        return 0;
+    }
+    r->fp = fopen(path, "wb");
+    if(!r->fp) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+int render_write(Render_file_t *r, const INT32 *interleaved, UINT32 frames) {
+    UINT32 samples = frames * r->channels;
+    if(r->wav) {
+        INT32 ret = aweOS_wavFileWrite(r->fp, (void *)interleaved, samples, sizeof(INT32));
+        if(ret != (INT32)samples) {
+            fprintf(stderr, "aweOS_wavFileWrite: %s\n", ret < 0 ? aweOS_errorToString(ret) : "short write");
+            return -1;
+        }
+    } else if(fwrite(interleaved, sizeof(INT32), samples, r->fp) != samples) {
+        perror("render");
+        return -1;
+    }
+    r->frames += frames;
+    return 0;
+}
+
+void render_close(Render_file_t *r) {
+    if(!r->fp) {
+        return;
+    }
+    if(r->wav) {
+        aweOS_wavFileClose(r->fp);
+    } else {
+        fclose(r->fp);
+    }
+    r->fp = NULL;
+}
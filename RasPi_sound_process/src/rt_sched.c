@@ -0,0 +1,224 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<errno.h>
+#include<pthread.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include"../inc/rt_sched.h"
+
+/*Default: everything SCHED_OTHER, unpinned, memory not locked (old behaviour)*/
+Rt_config_t rt_cfg;
+
+static const char *role_names[RT_ROLE_COUNT] = {
+    [RT_ROLE_PROCESS] = "process",
+    [RT_ROLE_READER]  = "reader",
+    [RT_ROLE_CONTROL] = "control",
+    [RT_ROLE_PUMP]    = "pump",
+};
+
+static const struct {
+    const char *name;
+    int policy;
+} policies[] = {
+    { "other", SCHED_OTHER },
+    { "fifo",  SCHED_FIFO },
+    { "rr",    SCHED_RR },
+};
+
+const char *rt_role_name(Rt_role_t role) {
+    return role_names[role];
+}
+
+int rt_parse_policy(const char *name, int *policy) {
+    for(size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        if(strcmp(name, policies[i].name) == 0) {
+            *policy = policies[i].policy;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static const char *policy_name(int policy) {
+    for(size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        if(policies[i].policy == policy) {
+            return policies[i].name;
+        }
+    }
+    return "?";
+}
+
+static int parse_cpu_list(const char *list, cpu_set_t *set) {
+    CPU_ZERO(set);
+    const char *p = list;
+    while(*p) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        if(end == p || first < 0) {
+            return -1;
+        }
+        if(*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if(end == p || last < first) {
+                return -1;
+            }
+        }
+        if(last >= CPU_SETSIZE) {
+            return -1;
+        }
+        for(long cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, set);
+        }
+        if(*end == ',') {
+            end++;
+        } else if(*end != '\0') {
+            return -1;
+        }
+        p = end;
+    }
+    return CPU_COUNT(set) > 0 ? 0 : -1;
+}
+
+int rt_parse_affinity(const char *spec) {
+    const char *eq = strchr(spec, '=');
+    if(!eq) {
+        return -1;
+    }
+    for(int r = 0; r < RT_ROLE_COUNT; r++) {
+        if(strlen(role_names[r]) == (size_t)(eq - spec) && strncmp(spec, role_names[r], eq - spec) == 0) {
+            if(parse_cpu_list(eq + 1, &rt_cfg.role[r].cpus) != 0) {
+                return -1;
+            }
+            rt_cfg.role[r].pinned = 1;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void format_cpus(const cpu_set_t *set, char *buf, size_t len) {
+    size_t n = 0;
+    buf[0] = '\0';
+    for(int cpu = 0; cpu < CPU_SETSIZE && n < len; cpu++) {
+        if(CPU_ISSET(cpu, set)) {
+            n += snprintf(buf + n, len - n, n ? ",%d" : "%d", cpu);
+        }
+    }
+}
+
+void rt_log_config(void) {
+    char cpus[64];
+    printf("Scheduling:%s\n", rt_cfg.lock_memory ? " memory locked" : "");
+    for(int r = 0; r < RT_ROLE_COUNT; r++) {
+        const Rt_role_cfg_t *role = &rt_cfg.role[r];
+        if(role->pinned) {
+            format_cpus(&role->cpus, cpus, sizeof(cpus));
+        } else {
+            strcpy(cpus, "any");
+        }
+        if(r == RT_ROLE_PUMP) {
+            printf("  %-8s priority from AWE, cpus %s\n", role_names[r], cpus);
+        } else {
+            printf("  %-8s %s %d, cpus %s\n", role_names[r], policy_name(role->policy),
+                   role->policy == SCHED_OTHER ? 0 : role->priority, cpus);
+        }
+    }
+}
+
+int rt_lock_memory(void) {
+    if(!rt_cfg.lock_memory) {
+        return 0;
+    }
+    /*
+     * On-fault locking where available: MCL_CURRENT alone would page in
+     * every input file mapping. Buffers that matter are prefaulted instead.
+     */
+    int flags = MCL_CURRENT | MCL_FUTURE;
+#ifdef MCL_ONFAULT
+    flags |= MCL_ONFAULT;
+#endif
+    if(mlockall(flags) != 0) {
+        fprintf(stderr, "mlockall: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+void rt_prefault(void *buf, size_t bytes) {
+    volatile unsigned char *p = buf;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for(size_t off = 0; off < bytes; off += page) {
+        p[off] = p[off];
+    }
+    if(bytes) {
+        p[bytes - 1] = p[bytes - 1];
+    }
+}
+
+static void prefault_stack(void) {
+    volatile unsigned char stack[RT_STACK_PREFAULT];
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for(size_t off = 0; off < sizeof(stack); off += page) {
+        stack[off] = 0;
+    }
+}
+
+int rt_enter(Rt_role_t role) {
+    const Rt_role_cfg_t *cfg = &rt_cfg.role[role];
+    int ret = 0, err;
+
+    if(cfg->pinned) {
+        err = pthread_setaffinity_np(pthread_self(), sizeof(cfg->cpus), &cfg->cpus);
+        if(err != 0) {
+            fprintf(stderr, "%s thread: can't set affinity: %s\n", role_names[role], strerror(err));
+            ret = -1;
+        }
+    }
+    if(role != RT_ROLE_PUMP) {
+        struct sched_param param = { .sched_priority = cfg->policy == SCHED_OTHER ? 0 : cfg->priority };
+        err = pthread_setschedparam(pthread_self(), cfg->policy, &param);
+        if(err != 0) {
+            fprintf(stderr, "%s thread: can't set %s %d: %s\n", role_names[role],
+                    policy_name(cfg->policy), param.sched_priority, strerror(err));
+            ret = -1;
+        }
+    }
+    if(rt_cfg.lock_memory) {
+        prefault_stack();
+    }
+    return ret;
+}
+
+static int pin_tid(UINT32 tid, Rt_role_t role) {
+    if(tid == 0 || !rt_cfg.role[role].pinned) {
+        return 0;
+    }
+    if(sched_setaffinity((pid_t)tid, sizeof(cpu_set_t), &rt_cfg.role[role].cpus) != 0) {
+        fprintf(stderr, "AWE thread %u: can't set affinity: %s\n", tid, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+int rt_pin_awe_threads(AWEOSInstance *instance) {
+    AWEOSThreadPIDs_t pids;
+    memset(&pids, 0, sizeof(pids));
+    if(aweOS_getThreadPIDs(instance, &pids) != E_SUCCESS) {
+        fprintf(stderr, "aweOS_getThreadPIDs failed\n");
+        return -1;
+    }
+    int ret = pin_tid(pids.workThreadPID, RT_ROLE_PUMP);
+    ret |= pin_tid(pids.socketThreadPID, RT_ROLE_CONTROL);
+    for(UINT32 i = 0; i < pids.numPumpThreads && pids.pumpThreadPIDs; i++) {
+        ret |= pin_tid(pids.pumpThreadPIDs[i], RT_ROLE_PUMP);
+    }
+    printf("AWE threads: work %u, socket %u, %u pump%s", pids.workThreadPID, pids.socketThreadPID,
+           pids.numPumpThreads, pids.numPumpThreads && pids.pumpThreadPIDs ? " (" : "\n");
+    for(UINT32 i = 0; i < pids.numPumpThreads && pids.pumpThreadPIDs; i++) {
+        printf(i + 1 < pids.numPumpThreads ? "%u " : "%u)\n", pids.pumpThreadPIDs[i]);
+    }
+    return ret ? -1 : 0;
+}
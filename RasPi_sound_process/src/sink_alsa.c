@@ -0,0 +1,300 @@
+#include"../inc/sound_process.h"
+
+#ifndef NO_ALSA
+static int set_hw_params(PCM_device_t *device, snd_pcm_uframes_t period, unsigned int periods) {
+    snd_pcm_t *pcm = device->dev;
+    snd_pcm_hw_params_t *hw;
+    unsigned int rate = geom.sample_rate;
+    int err, dir = 0;
+
+    snd_pcm_hw_params_alloca(&hw);
+    if((err = snd_pcm_hw_params_any(pcm, hw)) < 0 ||
+       (err = snd_pcm_hw_params_set_access(pcm, hw, device->access)) < 0 ||
+       (err = snd_pcm_hw_params_set_format(pcm, hw, SND_PCM_FORMAT_S32_LE)) < 0 ||
+       (err = snd_pcm_hw_params_set_channels(pcm, hw, geom.out_channels)) < 0 ||
+       (err = snd_pcm_hw_params_set_rate_resample(pcm, hw, 1)) < 0 ||
+       (err = snd_pcm_hw_params_set_rate(pcm, hw, rate, 0)) < 0) {
+        fprintf(stderr, "hw_params: %s\n", snd_strerror(err));
+        return -1;
+    }
+    /*Prefer the exact period, the buffer follows from the period count*/
+    err = snd_pcm_hw_params_set_period_size(pcm, hw, period, 0);
+    if(err < 0) {
+        dir = 0;
+        snd_pcm_hw_params_set_period_size_near(pcm, hw, &period, &dir);
+    }
+    err = snd_pcm_hw_params_set_periods(pcm, hw, periods, 0);
+    if(err < 0) {
+        dir = 0;
+        snd_pcm_hw_params_set_periods_near(pcm, hw, &periods, &dir);
+    }
+    if((err = snd_pcm_hw_params(pcm, hw)) < 0) {
+        fprintf(stderr, "hw_params: can't apply: %s\n", snd_strerror(err));
+        return -1;
+    }
+    snd_pcm_hw_params_get_period_size(hw, &device->period_size, &dir);
+    snd_pcm_hw_params_get_buffer_size(hw, &device->buffer_size);
+    return 0;
+}
+
+static int set_sw_params(PCM_device_t *device, snd_pcm_uframes_t start) {
+    snd_pcm_sw_params_t *sw;
+    int err;
+
+    /*A whole block is written at once, so wake up only when one fits*/
+    device->avail_min = geom.block_size < device->buffer_size ? geom.block_size : device->buffer_size;
+    device->start_threshold = start == 0 || start > device->buffer_size ? device->buffer_size : start;
+    snd_pcm_sw_params_alloca(&sw);
+    if((err = snd_pcm_sw_params_current(device->dev, sw)) < 0 ||
+       (err = snd_pcm_sw_params_set_avail_min(device->dev, sw, device->avail_min)) < 0 ||
+       (err = snd_pcm_sw_params_set_start_threshold(device->dev, sw, device->start_threshold)) < 0 ||
+       (err = snd_pcm_sw_params(device->dev, sw)) < 0) {
+        fprintf(stderr, "sw_params: %s\n", snd_strerror(err));
+        return -1;
+    }
+    return 0;
+}
+
+static int alsa_open(Audio_sink_t *sink) {
+    PCM_device_t *device = &sink->pcm;
+    UINT32 period, periods, start;
+    printf("Initializing pcm device...\n");
+    int err = snd_pcm_open(&device->dev, "default", SND_PCM_STREAM_PLAYBACK, 0);
+    if(err < 0) {
+        fprintf(stderr, "snd_pcm_open: can't open device: %s\n", snd_strerror(err));
+        return -1;
+    }
+    device->access = sink->type == SINK_ALSA_MMAP ? SND_PCM_ACCESS_MMAP_INTERLEAVED
+                                                  : SND_PCM_ACCESS_RW_INTERLEAVED;
+    if(sink_buffer_geometry(&period, &periods, &start) != 0 ||
+       set_hw_params(device, period, periods) != 0 ||
+       set_sw_params(device, start) != 0) {
+        return -1;
+    }
+    device->silence = calloc((size_t)geom.block_size * geom.out_channels, sizeof(INT32));
+    if(!device->silence) {
+        return -1;
+    }
+
+    if(!sink_block_aligned(device->period_size)) {
+        fprintf(stderr, "warning: device period %lu frames is not aligned to the %u frame block\n",
+                device->period_size, geom.block_size);
+    }
+    if(device->buffer_size < 2 * geom.block_size) {
+        fprintf(stderr, "warning: buffer of %lu frames holds less than two blocks, expect xruns\n",
+                device->buffer_size);
+    }
+    printf("PCM %s, profile %s: period %lu frames (%.2f ms) x %lu, buffer %.2f ms, start %.2f ms, avail_min %lu, "
+           "xrun %s\n",
+           snd_pcm_access_name(device->access), pcm_profile_name(pipeline_cfg.pcm_profile),
+           device->period_size, 1000.0 * device->period_size / geom.sample_rate,
+           device->buffer_size / device->period_size,
+           1000.0 * device->buffer_size / geom.sample_rate,
+           1000.0 * device->start_threshold / geom.sample_rate,
+           device->avail_min, xrun_policy_name(pipeline_cfg.xrun_policy));
+    return 0;
+}
+
+static int write_block_rw(PCM_device_t *device) {
+    export_block(output_channels);
+    int frames = snd_pcm_writei(device->dev, output_channels, geom.block_size);
+    return frames < 0 ? frames : 0;
+}
+
+/*Copy frames from src into the mmap ring, which may wrap mid-block*/
+static int mmap_copy(snd_pcm_t *pcm, const INT32 *src, snd_pcm_uframes_t left) {
+    while(left > 0) {
+        const snd_pcm_channel_area_t *areas;
+        snd_pcm_uframes_t offset, frames = left;
+        int err = snd_pcm_mmap_begin(pcm, &areas, &offset, &frames);
+        if(err < 0) {
+            return err;
+        }
+        INT32 *dst = (INT32 *)((char *)areas[0].addr + areas[0].first / 8 + offset * areas[0].step / 8);
+        memcpy(dst, src, frames * sizeof(INT32) * geom.out_channels);
+        snd_pcm_sframes_t done = snd_pcm_mmap_commit(pcm, offset, frames);
+        if(done < 0 || (snd_pcm_uframes_t)done != frames) {
+            return done < 0 ? (int)done : -EPIPE;
+        }
+        src += frames * geom.out_channels;
+        left -= frames;
+    }
+    return 0;
+}
+
+/*
+ * Export straight into the hardware ring with outStride = out_channels.
+ * Only when the ring wraps inside this block does it go through
+ * output_channels and get copied in two pieces.
+ */
+static int write_block_mmap(PCM_device_t *device) {
+    snd_pcm_t *pcm = device->dev;
+    int err;
+    while(1) {
+        snd_pcm_sframes_t avail = snd_pcm_avail_update(pcm);
+        if(avail < 0) {
+            err = (int)avail;
+            return err;
+        }
+        if((snd_pcm_uframes_t)avail >= geom.block_size) {
+            break;
+        }
+        if(snd_pcm_state(pcm) == SND_PCM_STATE_PREPARED) {
+            /*Buffer is full but below start threshold (e.g. odd buffer size)*/
+            snd_pcm_start(pcm);
+        }
+        err = snd_pcm_wait(pcm, 1000);
+        if(err < 0) {
+            return err;
+        }
+    }
+
+    const snd_pcm_channel_area_t *areas;
+    snd_pcm_uframes_t offset, frames = geom.block_size;
+    err = snd_pcm_mmap_begin(pcm, &areas, &offset, &frames);
+    if(err < 0) {
+        return err;
+    }
+    if(frames == geom.block_size) {
+        INT32 *dst = (INT32 *)((char *)areas[0].addr + areas[0].first / 8 + offset * areas[0].step / 8);
+        const UINT64 since = stage_ticks();
+        for(UINT32 ch = 0; ch < geom.out_channels; ch++) {
+            aweOS_audioExportSamples(awe, dst + ch, geom.out_channels, ch, AWE_SAMPLE_TYPE);
+        }
+        stage_export_done(since);
+        snd_pcm_sframes_t done = snd_pcm_mmap_commit(pcm, offset, frames);
+        if(done < 0 || done != geom.block_size) {
+            err = done < 0 ? (int)done : -EPIPE;
+            return err;
+        }
+    } else {
+        /*Nothing was written yet, give the area back and go through the bounce buffer*/
+        snd_pcm_mmap_commit(pcm, offset, 0);
+        export_block(output_channels);
+        err = mmap_copy(pcm, output_channels, geom.block_size);
+        if(err < 0) {
+            return err;
+        }
+    }
+
+    if(snd_pcm_state(pcm) == SND_PCM_STATE_PREPARED &&
+       device->buffer_size - snd_pcm_avail_update(pcm) >= device->start_threshold) {
+        err = snd_pcm_start(pcm);
+        if(err < 0) {
+            return err;
+        }
+    }
+    return 0;
+}
+
+/*Queue silence ahead of the retried block, it stays below the start threshold*/
+static int write_silence(PCM_device_t *device, snd_pcm_uframes_t frames) {
+    while(frames > 0) {
+        snd_pcm_uframes_t n = frames < geom.block_size ? frames : geom.block_size;
+        int err = device->access == SND_PCM_ACCESS_MMAP_INTERLEAVED
+                      ? mmap_copy(device->dev, device->silence, n)
+                      : (int)snd_pcm_writei(device->dev, device->silence, n);
+        if(err < 0) {
+            return err;
+        }
+        frames -= n;
+    }
+    return 0;
+}
+
+/*
+ * Underrun: bring the stream back as pipeline_cfg.xrun_policy says and log
+ * it. Anything else snd_pcm_recover can't fix ends the stream.
+ */
+static int alsa_recover(Audio_sink_t *sink, int err) {
+    PCM_device_t *device = &sink->pcm;
+    snd_pcm_t *pcm = device->dev;
+    const UINT64 block = sink->frames / geom.block_size;
+    snd_pcm_uframes_t prefill = 0;
+
+    if(err != -EPIPE) {
+        if(err == -EINTR || (err = snd_pcm_recover(pcm, err, 1)) == 0) {
+            return 0;
+        }
+        fprintf(stderr, "pcm write failed: %s\n", snd_strerror(err));
+        xrun_report(XRUN_EVENT_ERROR, err, block, device->buffer_size, 0);
+        return -1;
+    }
+
+    Xrun_policy_t policy = pipeline_cfg.xrun_policy;
+    const unsigned int periods = device->buffer_size / device->period_size;
+    if(policy == XRUN_GROW && periods < XRUN_MAX_PERIODS) {
+        /*A full-buffer start threshold grows with the buffer*/
+        snd_pcm_uframes_t start = device->start_threshold == device->buffer_size ? 0 : device->start_threshold;
+        snd_pcm_drop(pcm);
+        snd_pcm_hw_free(pcm);
+        if(set_hw_params(device, device->period_size, periods + 1) != 0 || set_sw_params(device, start) != 0) {
+            xrun_report(XRUN_EVENT_ERROR, -EINVAL, block, device->buffer_size, 0);
+            return -1;
+        }
+    }
+    err = snd_pcm_prepare(pcm);
+    if(err == 0 && policy == XRUN_PREFILL && device->start_threshold > geom.block_size) {
+        prefill = device->start_threshold - geom.block_size;
+        err = write_silence(device, prefill);
+    }
+    if(err < 0) {
+        fprintf(stderr, "xrun recovery failed: %s\n", snd_strerror(err));
+        xrun_report(XRUN_EVENT_ERROR, err, block, device->buffer_size, 0);
+        return -1;
+    }
+    xrun_report(XRUN_EVENT_UNDERRUN, -EPIPE, block, device->buffer_size, prefill);
+    return 0;
+}
+
+/*The block is exported again after a recovery, the pumped output is still there*/
+static int alsa_write(Audio_sink_t *sink) {
+    for(int attempt = 0; attempt < 2; attempt++) {
+        int err = sink->type == SINK_ALSA_MMAP ? write_block_mmap(&sink->pcm) : write_block_rw(&sink->pcm);
+        if(err == 0) {
+            return 0;
+        }
+        if(alsa_recover(sink, err) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void alsa_drain(Audio_sink_t *sink) {
+    snd_pcm_drain(sink->pcm.dev);
+}
+
+static void alsa_close(Audio_sink_t *sink) {
+    if(sink->pcm.dev) {
+        snd_pcm_close(sink->pcm.dev);
+        sink->pcm.dev = NULL;
+    }
+    free(sink->pcm.silence);
+    sink->pcm.silence = NULL;
+}
+
+#else /*NO_ALSA: native build without libasound*/
+
+static int alsa_open(Audio_sink_t *sink) {
+    (void)sink;
+    fprintf(stderr, "Built without ALSA, use --sink null|null-clocked|file:PATH\n");
+    return -1;
+}
+
+static int alsa_write(Audio_sink_t *sink) {
+    (void)sink;
+    return -1;
+}
+
+static void alsa_drain(Audio_sink_t *sink) {
+    (void)sink;
+}
+
+static void alsa_close(Audio_sink_t *sink) {
+    (void)sink;
+}
+
+#endif /*NO_ALSA*/
+
+const Audio_sink_ops_t sink_alsa_ops = { alsa_open, alsa_write, alsa_drain, alsa_close };
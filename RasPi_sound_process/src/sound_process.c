@@ -1,30 +1,32 @@
 #include"../inc/sound_process.h"
 
-pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t cond_reader = PTHREAD_COND_INITIALIZER;
-pthread_cond_t cond_main = PTHREAD_COND_INITIALIZER;
+AWEOSInstance *awe;
+
+Pipeline_config_t pipeline_cfg = { RING_DEPTH, 0, 0, SOURCE_IO_STDIO, LAYOUT_PLANAR, SINK_ALSA, NULL,
+                                   PCM_PROFILE_SAFE, 0, 0, XRUN_RESTART, AWE_DEFAULT_THREADS, 0, NULL, 0 };
+Awe_geometry_t geom;
+Block_ring_t *source_rings;
+Read_file_t *sources;
+UINT32 num_sources;
+INT32 *output_channels;
+static INT32 *output_planar;
+static INT32 *silence;
 
 const void* moduleDescriptorTable[] = {
     LISTOFCLASSOBJECTS
 };
 UINT32 moduleDescriptorTableSize = sizeof(moduleDescriptorTable) / sizeof(moduleDescriptorTable[0]);
 
-int init_pcm(PCM_device_t *device) {
-    printf("Initializing pcm device...\n");
-    int err = snd_pcm_open(&device->dev, "default", SND_PCM_STREAM_PLAYBACK, 0);
-    if(err < 0) {
-        fprintf(stderr, "snd_pcm_open: can't open device\n", snd_strerror(err));
+static int load_graph(const AWEOSConfigParameters *config, const char *file) {
+    int ret = aweOS_init(&awe, config, moduleDescriptorTable, moduleDescriptorTableSize);
+    if(ret < 0) {
+        fprintf(stderr, "aweOS_init: can't init aweOS %d\n", ret);
         return -1;
     }
-    err = snd_pcm_set_params( device->dev, 
-                              SND_PCM_FORMAT_S32_LE,
-                              SND_PCM_ACCESS_RW_INTERLEAVED,
-                              AWE_OUT_CHANNELS,
-                              AWE_SAMPLE_RATE,
-                              1,
-                              100000 );
-    if(err < 0) {
-        fprintf(stderr, "snd_pcm_set_parameter: can't set parameter\n", snd_strerror(err));
+    UINT32 pos;
+    ret = aweOS_loadAWBFile(awe, file, &pos);
+    if (ret != 0) {
+        fprintf(stderr, "Failed to load AWB graph at pos %u: %s\n", pos, aweOS_errorToString(ret));
         return -1;
     }
     return 0;
@@ -34,22 +36,54 @@ int init_aweCoreOS(const char* file) {
     printf("Initializing AWECoreOS...\n");
     AWEOSConfigParameters config;
     aweOS_getParamDefaults(&config);
-    config.inChannels = AWE_IN_CHANNELS;
-    config.outChannels = AWE_OUT_CHANNELS;
-    config.sampleRate = AWE_SAMPLE_RATE;
-    config.fundamentalBlockSize = AWE_BLOCK_SIZE;
-    config.numThreads = 4;
+    config.inChannels = AWE_DEFAULT_IN_CHANNELS;
+    config.outChannels = AWE_DEFAULT_OUT_CHANNELS;
+    config.sampleRate = AWE_DEFAULT_SAMPLE_RATE;
+    config.fundamentalBlockSize = AWE_DEFAULT_BLOCK_SIZE;
+    config.numThreads = pipeline_cfg.awe_threads;
+    if(load_graph(&config, file) != 0) {
+        return -1;
+    }
 
-    int ret = aweOS_init(&awe, &config, moduleDescriptorTable, moduleDescriptorTableSize);
-    if(ret < 0) {
-        fprintf(stderr, "aweOS_init: can't init aweOS %d\n", ret);
+    /*The graph decides the geometry, re-create the instance if the guess was wrong*/
+    UINT32 in, out, block;
+    FLOAT32 rate;
+    if(aweOS_layoutGetChannelCount(awe, &in, &out) != E_SUCCESS ||
+       aweOS_layoutGetBlockSize(awe, &block) != E_SUCCESS ||
+       aweOS_layoutGetSampleRate(awe, &rate) != E_SUCCESS) {
+        fprintf(stderr, "Can't query layout geometry\n");
+        return -1;
     }
-    UINT32 pos;
-    ret = aweOS_loadAWBFile(awe, file, &pos);
-    if (ret != 0) {
-        fprintf(stderr, "Failed to load AWB graph at pos %u: %s\n", pos, aweOS_errorToString(ret));
+    UINT32 sample_rate = (UINT32)(rate + 0.5f);
+    if(in != config.inChannels || out != config.outChannels ||
+       block != config.fundamentalBlockSize || sample_rate != config.sampleRate) {
+        printf("Layout is %u in / %u out, %u frames @ %u Hz, re-initializing\n", in, out, block, sample_rate);
+        aweOS_destroy(&awe);
+        config.inChannels = in;
+        config.outChannels = out;
+        config.fundamentalBlockSize = block;
+        config.sampleRate = sample_rate;
+        if(load_graph(&config, file) != 0) {
+            return -1;
+        }
+    }
+    if(in == 0 || out == 0 || block == 0 || sample_rate == 0) {
+        fprintf(stderr, "Unsupported layout: %u in / %u out, %u frames @ %u Hz\n", in, out, block, sample_rate);
         return -1;
     }
+    geom.in_channels = in;
+    geom.out_channels = out;
+    geom.block_size = block;
+    geom.sample_rate = sample_rate;
+    geom.block_ns = 1000000000LL * block / sample_rate;
+    geom.core_speed = config.coreSpeed;
+    geom.profile_speed = config.profileSpeed;
+    printf("Geometry: %u in / %u out, %u frames @ %u Hz (%.2f ms blocks)\n",
+           in, out, block, sample_rate, geom.block_ns / 1e6);
+
+    if(!sink_is_clocked(pipeline_cfg.sink)) {
+        return 0;
+    }
     INT32 tuningRet = aweOS_tuningSocketOpen(&awe, AWE_PORT_NO, 1); 
     if (tuningRet < 0)
     {
@@ -91,7 +125,7 @@ int init_TCPSocket(int *server_fd) {
         return -1;
     }
     
-    if(listen(*server_fd, 1) == -1) {
+    if(listen(*server_fd, SOMAXCONN) == -1) {
         fprintf(stderr, "Failed listen()\n", strerror(-1));
         return -1;
     }
@@ -99,128 +133,426 @@ int init_TCPSocket(int *server_fd) {
     return 0;
 }
 
-void *read_thread(void* arg) {
-    Read_file_t *cfg = (Read_file_t *)arg;
-    // printf("Started read thread for channel offset: %d\n", cfg->channel_offset);
-    FILE* file = fopen(cfg->file, "rb");
-    if (!file) {
-        perror("fopen");
+static void *alloc_buffer(size_t bytes) {
+    void *buf;
+    if(posix_memalign(&buf, RING_CACHE_LINE, bytes) != 0) {
+        return NULL;
     }
-    //printf("thread %d", cfg->channel_offset);
-    INT32 temp[AWE_BLOCK_SIZE * 2];  // stereo interleaved
+    memset(buf, 0, bytes);
+    return buf;
+}
 
-    while (fread(temp, sizeof(INT32), AWE_BLOCK_SIZE * 2, file) == AWE_BLOCK_SIZE * 2) {
-        pthread_mutex_lock(&mutex);
-        // Wait if channels are full
-        while (ready_channels[cfg->channel_offset] && ready_channels[cfg->channel_offset + 1]) {
-            pthread_cond_wait(&cond_reader, &mutex);
+int init_buffers(void) {
+    const size_t out_bytes = sizeof(INT32) * geom.out_channels * geom.block_size;
+    output_channels = alloc_buffer(out_bytes);
+    output_planar = alloc_buffer(out_bytes);
+    /*Stands in for ended sources and AWE inputs no source feeds*/
+    silence = alloc_buffer(sizeof(INT32) * geom.in_channels * geom.block_size);
+    if(!output_channels || !output_planar || !silence) {
+        fprintf(stderr, "init_buffers: out of memory\n");
+        return -1;
+    }
+    stage_init(geom.block_ns);
+    return 0;
+}
+
+/*"file.pcm[:channels[@offset]]", offset defaults to right after the previous source*/
+int parse_source(const char *arg, Read_file_t *rd) {
+    static UINT32 next_offset;
+    char *end;
+    rd->channels = SOURCE_CHANNELS;
+    rd->channel_offset = next_offset;
+    const char *colon = strrchr(arg, ':');
+    if(colon && colon[1] >= '0' && colon[1] <= '9') {
+        rd->channels = strtoul(colon + 1, &end, 10);
+        if(*end == '@') {
+            rd->channel_offset = strtoul(end + 1, &end, 10);
         }
-        // Deinterleave
-        for (int i = 0; i < AWE_BLOCK_SIZE; ++i) {
-            input_channels[cfg->channel_offset][i]     = temp[2 * i];     // Left
-            input_channels[cfg->channel_offset + 1][i] = temp[2 * i + 1]; // Right
+        if(*end != '\0' || rd->channels == 0) {
+            return -1;
         }
-
-        // Mark ready
-        ready_channels[cfg->channel_offset] = 1;
-        ready_channels[cfg->channel_offset + 1] = 1;
-        pthread_cond_signal(&cond_main);
-        pthread_mutex_unlock(&mutex);
+        rd->file = strndup(arg, colon - arg);
+    } else {
+        rd->file = arg;
     }
+    next_offset = rd->channel_offset + rd->channels;
+    return rd->file ? 0 : -1;
+}
+
+/*Every AWE input fed by at most one source, the rest are listed in input_fed*/
+static unsigned char *input_fed;
 
-    fclose(file);
+static int check_source_map(const Read_file_t *readers, UINT32 count) {
+    unsigned char *fed = calloc(geom.in_channels, 1);
+    UINT32 unfed = geom.in_channels;
+    if(!fed) {
+        return -1;
+    }
+    for(UINT32 s = 0; s < count; s++) {
+        const Read_file_t *rd = &readers[s];
+        if(rd->channel_offset + rd->channels > geom.in_channels) {
+            fprintf(stderr, "%s: channels %u..%u are outside the %u graph inputs\n", rd->file,
+                    rd->channel_offset, rd->channel_offset + rd->channels - 1, geom.in_channels);
+            free(fed);
+            return -1;
+        }
+        for(UINT32 c = rd->channel_offset; c < rd->channel_offset + rd->channels; c++) {
+            if(fed[c]++) {
+                fprintf(stderr, "%s: graph input %u is already fed by another source\n", rd->file, c);
+                free(fed);
+                return -1;
+            }
+            unfed--;
+        }
+    }
+    if(unfed) {
+        printf("%u graph inputs have no source and get silence\n", unfed);
+    }
+    input_fed = fed;
+    return 0;
 }
 
-void *sound_processing(void *arg) {
-    PCM_device_t *device = (PCM_device_t *) arg;
-    while(1) {
-        pthread_mutex_lock(&mutex);
-        while(!(ready_channels[0] && ready_channels[1] && ready_channels[2] && ready_channels[3])) {
-            pthread_cond_wait(&cond_main, &mutex);
+int init_sources(Read_file_t *readers, UINT32 count) {
+    if(count == 0 || count > SOURCE_MAX || check_source_map(readers, count) != 0) {
+        fprintf(stderr, "init_sources: need 1..%d sources mapped inside the graph inputs\n", SOURCE_MAX);
+        return -1;
+    }
+    source_rings = calloc(count, sizeof(Block_ring_t));
+    if(!source_rings) {
+        return -1;
+    }
+    sources = readers;
+    num_sources = count;
+    for(UINT32 s = 0; s < count; s++) {
+        Read_file_t *rd = &readers[s];
+        const size_t frame_bytes = sizeof(INT32) * rd->channels;
+        rd->ring = &source_rings[s];
+        if(pcm_source_open(&rd->src, rd->file, pipeline_cfg.input_io, frame_bytes) != 0) {
+            perror(rd->file);
+            return -1;
+        }
+        rd->scratch = malloc(frame_bytes * geom.block_size);
+        if(!rd->scratch) {
+            return -1;
+        }
+        /*Zero-copy: slots only carry a pointer into the mapping*/
+        size_t slot = sizeof(Source_block_t);
+        if(pipeline_cfg.layout == LAYOUT_PLANAR || rd->src.io != SOURCE_IO_MMAP) {
+            slot += frame_bytes * geom.block_size;
+        }
+        if(ring_init(rd->ring, pipeline_cfg.queue_depth, pipeline_cfg.high_watermark,
+                     pipeline_cfg.low_watermark, slot) != 0) {
+            fprintf(stderr, "ring_init: invalid queue depth %u (high %u, low %u) or out of memory\n",
+                    pipeline_cfg.queue_depth, pipeline_cfg.high_watermark, pipeline_cfg.low_watermark);
+            return -1;
         }
+        /*The consumer may still be reading up to depth blocks behind the reader*/
+        rd->src.lag = (size_t)(rd->ring->depth + 2) * frame_bytes * geom.block_size;
+        printf("Source %u: %s, %u ch -> inputs %u..%u via %s, %s, %u x %zu byte slots (high %u, low %u), %.1f ms queued\n",
+               s, rd->file, rd->channels, rd->channel_offset, rd->channel_offset + rd->channels - 1,
+               pcm_source_io_name(rd->src.io),
+               pipeline_cfg.layout == LAYOUT_PLANAR ? "planar" : "interleaved",
+               rd->ring->depth, rd->ring->block_bytes, rd->ring->high, rd->ring->low,
+               rd->ring->depth * geom.block_ns / 1e6);
+    }
+    return 0;
+}
+
+int format_ring_stats(char *buf, size_t len) {
+    int n = 0;
+    for(UINT32 s = 0; s < num_sources && n < (int)len; s++) {
+        Ring_stats_t st;
+        char lat[128];
+        ring_get_stats(&source_rings[s], &st);
+        hist_format(&sources[s].src.read_lat, lat, sizeof(lat));
+        n += snprintf(buf + n, len - n,
+                      "source %d: fill %u/%u min %u max %u underruns %u low %u full %u blocks %u\n"
+                      "  read %s: %s, stalls %lu\n",
+                      (int)s, st.fill, st.depth, st.min_fill, st.max_fill,
+                      st.underruns, st.low_water_hits, st.full_waits, st.blocks,
+                      pcm_source_io_name(sources[s].src.io), lat, pcm_source_stalls(&sources[s].src));
+    }
+    if(n < (int)len) {
+        n += format_stage_stats(buf + n, len - n);
+    }
+    if(sink_is_clocked(pipeline_cfg.sink) && n < (int)len) {
+        n += format_xrun_stats(buf + n, len - n, 0);
+    }
+    if(n < (int)len) {
+        n += format_control_stats(buf + n, len - n);
+    }
+    if(n < (int)len) {
+        n += format_frame_stats(buf + n, len - n);
+    }
+    return n;
+}
 
-        //Import AWE
-        for(int ch = 0; ch < AWE_IN_CHANNELS; ch++) {
-            aweOS_audioImportSamples(awe, input_channels[ch], 1, ch, AWE_SAMPLE_TYPE);
+/*Backoff sleep once spinning didn't help; unclocked nothing should sit idle for long*/
+static long poll_ns(void) {
+    return sink_is_clocked(pipeline_cfg.sink) ? geom.block_ns / 4 : 20000;
+}
+
+void *read_thread(void* arg) {
+    Read_file_t *cfg = (Read_file_t *)arg;
+    // printf("Started read thread for channel offset: %d\n", cfg->channel_offset);
+    rt_enter(RT_ROLE_READER);
+
+    while (1) {
+        // Wait if ring is full, sound_processing never blocks on us
+        Source_block_t *block = ring_write_wait(cfg->ring, poll_ns());
+        if (pipeline_cfg.layout == LAYOUT_INTERLEAVED) {
+            // Read straight into the slot, or just point at the mapping
+            block->samples = pcm_source_next(&cfg->src, block->data, geom.block_size);
+            if (!block->samples)
+                break;
+        } else {
+            const INT32 *frames = pcm_source_next(&cfg->src, cfg->scratch, geom.block_size);
+            if (!frames)
+                break;
+            deinterleave_s32(block->data, frames, cfg->channels, geom.block_size);
+            block->samples = block->data;
         }
+        ring_write_commit(cfg->ring);
+    }
 
-        memset(ready_channels, 0, sizeof(ready_channels));
-        pthread_cond_broadcast(&cond_reader);
-        pthread_mutex_unlock(&mutex);
+    ring_close(cfg->ring);
+    pcm_source_close(&cfg->src);
+    return NULL;
+}
 
-        //Pump
-        aweOS_audioPumpAll(awe);
+static inline UINT64 all_sources_mask(void) {
+    return num_sources == 64 ? ~0ULL : (1ULL << num_sources) - 1;
+}
 
-        //Export for PCM device
-        for(int ch = 0; ch < AWE_OUT_CHANNELS; ch++) {
-            aweOS_audioExportSamples(awe, output_channels + ch, AWE_OUT_CHANNELS, ch, AWE_SAMPLE_TYPE);
+/*Prefill: wait until every source reached its high watermark or ended*/
+static void wait_sources_primed(void) {
+    unsigned spins = 0;
+    for(UINT32 s = 0; s < num_sources; s++) {
+        while(!ring_is_primed(&source_rings[s])) {
+            ring_backoff(&spins, poll_ns());
         }
+    }
+}
 
-        //Write to device
-        int frames = snd_pcm_writei(device->dev, output_channels, AWE_BLOCK_SIZE);
-        if(frames < 0) {
-            frames = snd_pcm_recover(device->dev, frames, 0);
-            if(frames < 0) {
-                fprintf(stderr, "snd_pcm_writei failed: %s\n", snd_strerror(frames));
-                break;
+/*
+ * Wait without locking until every source has a block or has ended, -1 when
+ * all ended. Only sources still pending are polled again.
+ */
+static int wait_sources_ready(void) {
+    unsigned spins = 0;
+    UINT64 pending = all_sources_mask(), drained = 0;
+    for(UINT32 s = 0; s < num_sources; s++) {
+        ring_account_read(&source_rings[s]);
+    }
+    while(1) {
+        for(UINT64 m = pending; m; m &= m - 1) {
+            const int s = __builtin_ctzll(m);
+            if(ring_read_begin(&source_rings[s]) != NULL) {
+                pending &= ~(1ULL << s);
+            } else if(ring_is_drained(&source_rings[s])) {
+                pending &= ~(1ULL << s);
+                drained |= 1ULL << s;
             }
         }
+        if(drained == all_sources_mask()) {
+            return -1;
+        }
+        if(!pending) {
+            return 0;
+        }
+        ring_backoff(&spins, sink_is_clocked(pipeline_cfg.sink) ? 100000 : poll_ns());
     }
 }
 
-void socket_chat(int client_fd) {
-    int numb_read;
-    char recvbuff[TCP_BUFF_SIZE];
+/*Export one block, interleaved, using the layout's export path*/
+void export_block(INT32 *dst) {
+    const UINT64 since = stage_ticks();
+    if(pipeline_cfg.layout == LAYOUT_INTERLEAVED) {
+        for(UINT32 ch = 0; ch < geom.out_channels; ch++) {
+            aweOS_audioExportSamples(awe, dst + ch, geom.out_channels, ch, AWE_SAMPLE_TYPE);
+        }
+    } else {
+        for(UINT32 ch = 0; ch < geom.out_channels; ch++) {
+            aweOS_audioExportSamples(awe, output_planar + ch * geom.block_size, 1, ch, AWE_SAMPLE_TYPE);
+        }
+        interleave_s32(dst, output_planar, geom.out_channels, geom.block_size);
+    }
+    stage_export_done(since);
+}
 
-    while (1)
-    {
-        memset(recvbuff, 0, TCP_BUFF_SIZE);
-        
-        numb_read = recv(client_fd, recvbuff, TCP_BUFF_SIZE, 0);
-
-        if (numb_read <= 0) {
-            if (numb_read == 0)
-                printf("Client disconnected.\n");
-            else
-                fprintf(stderr, "Failed recv()\n", strerror(-1));
-            break;
+static UINT64 blocks_pumped; //block index control acks refer to
+
+/*Import one block from every source and pump it, -1 once all sources ended*/
+static int process_block(void) {
+    static int awe_threads_pinned;
+    if(wait_sources_ready() < 0) {
+        return -1;
+    }
+    stage_mark(STAGE_WAIT);
+
+    //Queued control writes take effect from this block on, timed as import
+    control_apply(blocks_pumped);
+
+    //Import AWE, a source that already ended plays silence
+    const int interleaved = pipeline_cfg.layout == LAYOUT_INTERLEAVED;
+    for(UINT32 s = 0; s < num_sources; s++) {
+        const Read_file_t *rd = &sources[s];
+        Source_block_t *block = ring_read_begin(&source_rings[s]);
+        const INT32 *samples = block ? block->samples : silence;
+        const int stride = interleaved ? rd->channels : 1;
+        for(UINT32 c = 0; c < rd->channels; c++) {
+            const INT32 *first = samples + (interleaved ? c : c * geom.block_size);
+            aweOS_audioImportSamples(awe, (void *)first, stride, rd->channel_offset + c, AWE_SAMPLE_TYPE);
         }
+        if(block) {
+            ring_read_release(&source_rings[s]);
+        }
+    }
+    for(UINT32 ch = 0; ch < geom.in_channels; ch++) {
+        if(!input_fed[ch]) {
+            aweOS_audioImportSamples(awe, (void *)silence, 1, ch, AWE_SAMPLE_TYPE);
+        }
+    }
 
-        recvbuff[numb_read] = '\0';
-        recvbuff[strcspn(recvbuff, "\r\n")] = 0; 
-        printf("\nMessage from client: %s\n", recvbuff);
+    stage_mark(STAGE_IMPORT);
+
+    //Pump, AWE starts its pump threads on the first call
+    aweOS_audioPumpAll(awe);
+    blocks_pumped++;
+    stage_mark(STAGE_PUMP);
+    if(!awe_threads_pinned) {
+        rt_pin_awe_threads(awe);
+        awe_threads_pinned = 1;
+    }
+    return 0;
+}
 
-        if (strncmp("exit", recvbuff, 4) == 0) {
-            system("clear");
+static void enter_process_role(void) {
+    rt_enter(RT_ROLE_PROCESS);
+    if(rt_cfg.lock_memory) {
+        rt_prefault(output_channels, sizeof(INT32) * geom.out_channels * geom.block_size);
+        rt_prefault(output_planar, sizeof(INT32) * geom.out_channels * geom.block_size);
+    }
+}
+
+static void print_source_stats(void) {
+    char stats[TCP_REPLY_SIZE];
+    format_ring_stats(stats, sizeof(stats));
+    printf("All input sources ended\n%s", stats);
+}
+
+/*One run summary for the benchmarks, a CSV row (header on a new file) or a JSON line*/
+static void write_report(const Audio_sink_t *sink, double elapsed) {
+    FILE *fp = fopen(pipeline_cfg.report_path, "a");
+    if(!fp) {
+        perror(pipeline_cfg.report_path);
+        return;
+    }
+    const char *ext = strrchr(pipeline_cfg.report_path, '.');
+    const int csv = ext && strcasecmp(ext, ".csv") == 0;
+    double audio = (double)sink->frames / geom.sample_rate;
+    unsigned long misses = atomic_load_explicit(&deadline_misses, memory_order_relaxed);
+    unsigned long long blocks = atomic_load_explicit(&busy_hist.total, memory_order_relaxed);
+    double busy_avg = blocks ? (double)atomic_load_explicit(&busy_hist.sum_ns, memory_order_relaxed) / blocks : 0;
+    if(csv && ftell(fp) == 0) {
+        fprintf(fp, "block,in_channels,out_channels,rate,sources,queue_depth,sink,awe_threads,frames,seconds,"
+                    "realtime_x,blocks,p50_us,p99_us,p999_us,max_us,load_avg_pct,deadline_us,deadline_misses,xruns\n");
+    }
+    fprintf(fp, csv ? "%u,%u,%u,%u,%u,%u,%s,%u,%llu,%.4f,%.2f,%llu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%lu,%lu\n"
+                    : "{\"block\":%u,\"in_channels\":%u,\"out_channels\":%u,\"rate\":%u,\"sources\":%u,"
+                      "\"queue_depth\":%u,\"sink\":\"%s\",\"awe_threads\":%u,\"frames\":%llu,\"seconds\":%.4f,"
+                      "\"realtime_x\":%.2f,\"blocks\":%llu,\"p50_us\":%.1f,\"p99_us\":%.1f,\"p999_us\":%.1f,"
+                      "\"max_us\":%.1f,\"load_avg_pct\":%.1f,\"deadline_us\":%.1f,\"deadline_misses\":%lu,\"xruns\":%lu}\n",
+            geom.block_size, geom.in_channels, geom.out_channels, geom.sample_rate, num_sources,
+            pipeline_cfg.queue_depth, sink_name(sink->type), pipeline_cfg.awe_threads,
+            (unsigned long long)sink->frames, elapsed, elapsed > 0 ? audio / elapsed : 0.0,
+            blocks, hist_percentile(&busy_hist, 50) / 1e3, hist_percentile(&busy_hist, 99) / 1e3,
+            hist_percentile(&busy_hist, 99.9) / 1e3,
+            atomic_load_explicit(&busy_hist.max_ns, memory_order_relaxed) / 1e3,
+            100.0 * busy_avg / geom.block_ns, geom.block_ns / 1e3, misses, xrun_count());
+    fclose(fp);
+}
+
+/*Pumps into the sink until every source ended, non-NULL on a sink error*/
+void *sound_processing(void *arg) {
+    Audio_sink_t *sink = (Audio_sink_t *) arg;
+    enter_process_role();
+    wait_sources_primed();
+    UINT64 start = hist_now_ns();
+    while(1) {
+        stage_begin();
+        if(process_block() < 0) {
             break;
-        } else if (strncmp("set ", recvbuff, 4) == 0) {
-            int objectID;
-            float newVal;
-            if (sscanf(recvbuff + 4, "%d %f", &objectID, &newVal) == 2) {
-                if(objectID == 30001) {
-                    if(newVal < -60 || newVal > 24) {
-                        send(client_fd, "Invalid value\n", 14, 0);
-                    } else {
-                        aweOS_ctrlSetValue(awe, AWE_ScalerN2_masterGain_HANDLE, &newVal, 0, AWE_ScalerN2_masterGain_SIZE);
-                        send(client_fd, "OK\n", 3, 0);
-                    }
-                } else if (objectID == 30002) {
-                    int val = (int) newVal;
-                    if(val != 0 && val != 1) {
-                        send(client_fd, "Invalid value\n", 14, 0);
-                    } else {
-                        aweOS_ctrlSetValue(awe, AWE_Mute1_isMuted_HANDLE, &val, 0, AWE_Mute1_isMuted_SIZE);
-                        send(client_fd, "OK\n", 3, 0);
-                    }
-                } else {
-                    send(client_fd, "Invalid object\n", 14, 0);
-                }
-            } else {
-                send(client_fd, "Invalid format\n", 15, 0);
-            }
+        }
+        if(sink_write(sink) != 0) {
+            control_queue_shutdown(blocks_pumped);
+            return sink;
+        }
+        stage_mark(STAGE_SINK);
+        stage_commit();
+    }
+    control_queue_shutdown(blocks_pumped);
+    print_source_stats();
+    sink_drain(sink);
+    double elapsed = (hist_now_ns() - start) / 1e9;
+    double audio = (double)sink->frames / geom.sample_rate;
+    printf("Sink %s: %llu frames (%.1f s of audio) in %.2f s: %.1fx realtime\n", sink_name(sink->type),
+           (unsigned long long)sink->frames, audio, elapsed, elapsed > 0 ? audio / elapsed : 0.0);
+    if(pipeline_cfg.report_path) {
+        write_report(sink, elapsed);
+    }
+    return NULL;
+}
+
+/*
+ * One control line, the reply goes into reply; -1 = close the connection.
+ * Writes go through the control queue, their reply is CONTROL_REPLY_LATER
+ * and done gets the ack.
+ */
+int control_command(const char *line, char *reply, size_t len, Control_done_t done, void *user) {
+    int n;
+    if (strncmp("exit", line, 4) == 0) {
+        return -1;
+    } else if (strncmp("set ", line, 4) == 0) {
+        int index;
+        const char *values;
+        char err[96];
+        Control_write_t w;
+        const Control_object_t *obj = control_resolve(line + 4, &index, &values);
+        if (!obj) {
+            n = snprintf(reply, len, "Invalid object\n");
+        } else if (control_parse_values(obj, index, values, &w, err, sizeof(err)) != 0) {
+            n = snprintf(reply, len, "%s\n", err);
+        } else if (control_submit(&w, done, user) < 0) {
+            n = snprintf(reply, len, "Busy\n");
+        } else {
+            return CONTROL_REPLY_LATER;
+        }
+    } else if (strncmp("get ", line, 4) == 0) {
+        int index;
+        const char *rest;
+        INT32 words[CONTROL_MAX_WORDS];
+        const Control_object_t *obj = control_resolve(line + 4, &index, &rest);
+        if (!obj || (index >= 0 && (UINT32)index >= obj->size)) {
+            n = snprintf(reply, len, "Invalid object\n");
         } else {
-            send(client_fd, "Unknown command\n", 16, 0);
+            /*Reads don't touch the pump, they go straight to AWE*/
+            UINT32 offset = index < 0 ? 0 : index;
+            UINT32 count = index >= 0 ? 1 : obj->size < CONTROL_MAX_WORDS ? obj->size : CONTROL_MAX_WORDS;
+            INT32 ret = aweOS_ctrlGetValue(awe, obj->handle, words, offset, count);
+            n = ret == E_SUCCESS ? control_format_values(obj, offset, words, count, reply, len)
+                                 : snprintf(reply, len, "Error: %s\n", aweOS_errorToString(ret));
         }
+    } else if (strncmp("list", line, 4) == 0) {
+        n = format_control_list(reply, len);
+    } else if (strncmp("stats", line, 5) == 0) {
+        n = format_ring_stats(reply, len);
+    } else if (strncmp("xruns", line, 5) == 0) {
+        n = format_xrun_stats(reply, len, 1);
+    } else if (strncmp("profile", line, 7) == 0) {
+        n = format_profile(reply, len);
+    } else {
+        n = snprintf(reply, len, "Unknown command\n");
     }
-    close(client_fd);
+    return n < (int)len ? n : (int)len - 1;
 }
@@ -0,0 +1,81 @@
+#include<stdio.h>
+#include"../inc/stage_timing.h"
+
+Latency_hist_t stage_hist[STAGE_COUNT];
+Latency_hist_t busy_hist;
+atomic_ulong deadline_misses;
+Stage_block_t stage_block;
+
+static double ns_per_tick = 1.0;
+static UINT64 deadline_ns;
+
+static const char *stage_names[STAGE_COUNT] = {
+    [STAGE_WAIT]   = "wait",
+    [STAGE_IMPORT] = "import",
+    [STAGE_PUMP]   = "pump",
+    [STAGE_EXPORT] = "export",
+    [STAGE_SINK]   = "sink",
+};
+
+void stage_init(UINT64 block_ns) {
+    deadline_ns = block_ns;
+#if defined(__aarch64__)
+    UINT64 freq;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+    ns_per_tick = 1e9 / freq;
+#elif defined(__x86_64__) || defined(__i386__)
+    /*TSC against the monotonic clock over 20 ms*/
+    struct timespec pause = { 0, 20000000 };
+    UINT64 t0 = hist_now_ns(), c0 = stage_ticks();
+    nanosleep(&pause, NULL);
+    UINT64 t1 = hist_now_ns(), c1 = stage_ticks();
+    ns_per_tick = c1 > c0 ? (double)(t1 - t0) / (c1 - c0) : 1.0;
+#endif
+}
+
+UINT64 stage_ticks_to_ns(UINT64 ticks) {
+    return (UINT64)(ticks * ns_per_tick);
+}
+
+const char *stage_name(Stage_t stage) {
+    return stage_names[stage];
+}
+
+void stage_commit(void) {
+    const Stage_block_t *b = &stage_block;
+    UINT64 ns[STAGE_COUNT];
+    ns[STAGE_WAIT] = stage_ticks_to_ns(b->end[STAGE_WAIT] - b->start);
+    ns[STAGE_IMPORT] = stage_ticks_to_ns(b->end[STAGE_IMPORT] - b->end[STAGE_WAIT]);
+    ns[STAGE_PUMP] = stage_ticks_to_ns(b->end[STAGE_PUMP] - b->end[STAGE_IMPORT]);
+    ns[STAGE_EXPORT] = stage_ticks_to_ns(b->export_ticks);
+    ns[STAGE_SINK] = stage_ticks_to_ns(b->end[STAGE_SINK] - b->end[STAGE_PUMP] - b->export_ticks);
+    for(int s = 0; s < STAGE_COUNT; s++) {
+        hist_record_single(&stage_hist[s], ns[s]);
+    }
+    UINT64 busy = ns[STAGE_IMPORT] + ns[STAGE_PUMP] + ns[STAGE_EXPORT];
+    hist_record_single(&busy_hist, busy);
+    if(busy > deadline_ns) {
+        atomic_store_explicit(&deadline_misses, atomic_load_explicit(&deadline_misses, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+    }
+}
+
+int format_stage_stats(char *buf, size_t len) {
+    int n = 0;
+    char lat[128];
+    for(int s = 0; s < STAGE_COUNT && n < (int)len; s++) {
+        hist_format(&stage_hist[s], lat, sizeof(lat));
+        n += snprintf(buf + n, len - n, "%-7s %s\n", stage_names[s], lat);
+    }
+    if(n < (int)len) {
+        unsigned long long blocks = atomic_load_explicit(&busy_hist.total, memory_order_relaxed);
+        unsigned long long sum = atomic_load_explicit(&busy_hist.sum_ns, memory_order_relaxed);
+        double period = deadline_ns ? (double)deadline_ns : 1.0;
+        n += snprintf(buf + n, len - n, "load avg %.1f%% p99 %.1f%% max %.1f%% of %.1f us, deadline missed %lu\n",
+                      blocks ? 100.0 * sum / blocks / period : 0.0,
+                      100.0 * hist_percentile(&busy_hist, 99) / period,
+                      100.0 * atomic_load_explicit(&busy_hist.max_ns, memory_order_relaxed) / period,
+                      period / 1e3, atomic_load_explicit(&deadline_misses, memory_order_relaxed));
+    }
+    return n;
+}
@@ -0,0 +1,214 @@
+#include<stdio.h>
+#include<string.h>
+#include<pthread.h>
+#include<semaphore.h>
+#include<stdatomic.h>
+#include"../inc/sound_process.h"
+
+static const char *policy_names[] = {
+    [XRUN_RESTART] = "restart",
+    [XRUN_PREFILL] = "prefill",
+    [XRUN_GROW]    = "grow",
+};
+
+/*Seqlock per slot: odd while the audio thread writes it*/
+typedef struct {
+    atomic_uint seq;
+    Xrun_event_t event;
+} Xrun_slot_t;
+
+static Xrun_slot_t xrun_log[XRUN_LOG];
+static atomic_ulong published; //events ever written, slot = n % XRUN_LOG
+static atomic_ulong underruns;
+static atomic_ulong errors;
+
+static struct {
+    Xrun_callback_t fn;
+    void *user;
+    UINT32 mask;
+} callbacks[XRUN_MAX_CALLBACKS];
+static int num_callbacks;
+static pthread_mutex_t callback_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static sem_t wakeup;
+static pthread_t notifier;
+static atomic_int running;
+
+int xrun_parse_policy(const char *name, Xrun_policy_t *policy) {
+    for(size_t i = 0; i < sizeof(policy_names) / sizeof(policy_names[0]); i++) {
+        if(strcmp(name, policy_names[i]) == 0) {
+            *policy = (Xrun_policy_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *xrun_policy_name(Xrun_policy_t policy) {
+    return policy_names[policy];
+}
+
+int xrun_register_callback(Xrun_callback_t callback, void *user, UINT32 mask) {
+    int ret = -1;
+    pthread_mutex_lock(&callback_lock);
+    if(num_callbacks < XRUN_MAX_CALLBACKS) {
+        callbacks[num_callbacks].fn = callback;
+        callbacks[num_callbacks].user = user;
+        callbacks[num_callbacks].mask = mask;
+        num_callbacks++;
+        ret = 0;
+    }
+    pthread_mutex_unlock(&callback_lock);
+    return ret;
+}
+
+void xrun_report(Xrun_kind_t kind, int error, UINT64 block, UINT32 buffer_frames, UINT32 prefill_frames) {
+    const Stage_block_t *b = &stage_block;
+    const UINT64 now = stage_ticks();
+    unsigned long n = atomic_load_explicit(&published, memory_order_relaxed);
+    Xrun_slot_t *slot = &xrun_log[n % XRUN_LOG];
+    Xrun_event_t *ev = &slot->event;
+
+    unsigned int seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    ev->kind = kind;
+    if(kind == XRUN_EVENT_UNDERRUN) {
+        atomic_fetch_add_explicit(&underruns, 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(&errors, 1, memory_order_relaxed);
+    }
+    ev->count = atomic_load_explicit(&underruns, memory_order_relaxed);
+    ev->block = block;
+    clock_gettime(CLOCK_REALTIME, &ev->wall);
+    /*Stages this block got through, the sink write up to now*/
+    ev->stage_ns[STAGE_WAIT] = stage_ticks_to_ns(b->end[STAGE_WAIT] - b->start);
+    ev->stage_ns[STAGE_IMPORT] = stage_ticks_to_ns(b->end[STAGE_IMPORT] - b->end[STAGE_WAIT]);
+    ev->stage_ns[STAGE_PUMP] = stage_ticks_to_ns(b->end[STAGE_PUMP] - b->end[STAGE_IMPORT]);
+    ev->stage_ns[STAGE_EXPORT] = stage_ticks_to_ns(b->export_ticks);
+    ev->stage_ns[STAGE_SINK] = stage_ticks_to_ns(now - b->end[STAGE_PUMP] - b->export_ticks);
+    ev->error = error;
+    ev->buffer_frames = buffer_frames;
+    ev->prefill_frames = prefill_frames;
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+    atomic_store_explicit(&published, n + 1, memory_order_release);
+    if(atomic_load_explicit(&running, memory_order_relaxed)) {
+        sem_post(&wakeup);
+    }
+}
+
+unsigned long xrun_count(void) {
+    return atomic_load_explicit(&underruns, memory_order_relaxed);
+}
+
+/*Copy event n out of the ring, -1 once it has been overwritten*/
+static int read_event(unsigned long n, Xrun_event_t *out) {
+    const Xrun_slot_t *slot = &xrun_log[n % XRUN_LOG];
+    while(1) {
+        if(atomic_load_explicit(&published, memory_order_acquire) - n > XRUN_LOG) {
+            return -1;
+        }
+        unsigned int seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if(seq & 1) {
+            continue;
+        }
+        memcpy(out, &slot->event, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        if(atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq) {
+            return 0;
+        }
+    }
+}
+
+static void *notify_thread(void *arg) {
+    (void)arg;
+    unsigned long seen = 0;
+    rt_enter(RT_ROLE_CONTROL);
+    while(1) {
+        while(sem_wait(&wakeup) != 0) {
+        }
+        unsigned long end = atomic_load_explicit(&published, memory_order_acquire);
+        if(end - seen > XRUN_LOG) {
+            seen = end - XRUN_LOG;
+        }
+        for(; seen < end; seen++) {
+            Xrun_event_t ev;
+            if(read_event(seen, &ev) != 0) {
+                continue;
+            }
+            pthread_mutex_lock(&callback_lock);
+            for(int i = 0; i < num_callbacks; i++) {
+                if(callbacks[i].mask & (1u << ev.kind)) {
+                    callbacks[i].fn(&ev, callbacks[i].user);
+                }
+            }
+            pthread_mutex_unlock(&callback_lock);
+        }
+        if(!atomic_load(&running)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+int xrun_start(void) {
+    if(sem_init(&wakeup, 0, 0) != 0) {
+        return -1;
+    }
+    atomic_store(&running, 1);
+    if(pthread_create(&notifier, NULL, notify_thread, NULL) != 0) {
+        atomic_store(&running, 0);
+        sem_destroy(&wakeup);
+        return -1;
+    }
+    return 0;
+}
+
+void xrun_stop(void) {
+    if(atomic_exchange(&running, 0)) {
+        sem_post(&wakeup);
+        pthread_join(notifier, NULL);
+        sem_destroy(&wakeup);
+    }
+}
+
+static int format_event(char *buf, size_t len, const Xrun_event_t *ev) {
+    struct tm tm;
+    char when[16];
+    localtime_r(&ev->wall.tv_sec, &tm);
+    strftime(when, sizeof(when), "%H:%M:%S", &tm);
+    int n = snprintf(buf, len, "%s #%lu block %llu at %s.%03ld:",
+                     ev->kind == XRUN_EVENT_UNDERRUN ? "xrun" : "error", ev->count,
+                     (unsigned long long)ev->block, when, ev->wall.tv_nsec / 1000000);
+    for(int s = 0; s < STAGE_COUNT && n < (int)len; s++) {
+        n += snprintf(buf + n, len - n, " %s %.1f", stage_name((Stage_t)s), ev->stage_ns[s] / 1e3);
+    }
+    if(n < (int)len) {
+        n += snprintf(buf + n, len - n, " us, buffer %.2f ms, prefill %.2f ms (%s)\n",
+                      1000.0 * ev->buffer_frames / geom.sample_rate,
+                      1000.0 * ev->prefill_frames / geom.sample_rate, strerror(-ev->error));
+    }
+    return n;
+}
+
+void xrun_log_callback(const Xrun_event_t *event, void *user) {
+    char line[256];
+    (void)user;
+    format_event(line, sizeof(line), event);
+    fputs(line, stderr);
+}
+
+int format_xrun_stats(char *buf, size_t len, int with_events) {
+    unsigned long end = atomic_load_explicit(&published, memory_order_acquire);
+    unsigned long first = !with_events ? end : end > XRUN_LOG ? end - XRUN_LOG : 0;
+    int n = snprintf(buf, len, "xruns %lu, errors %lu, policy %s\n", xrun_count(),
+                     atomic_load_explicit(&errors, memory_order_relaxed),
+                     xrun_policy_name(pipeline_cfg.xrun_policy));
+    for(unsigned long i = first; i < end && n < (int)len; i++) {
+        Xrun_event_t ev;
+        if(read_event(i, &ev) == 0) {
+            n += format_event(buf + n, len - n, &ev);
+        }
+    }
+    return n;
+}
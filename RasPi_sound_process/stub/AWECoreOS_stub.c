@@ -0,0 +1,613 @@
+/*
+ * Native stand-in for libAWECoreOS, enough of the aweOS_* API for
+ * sound_process and the benches to build and run on any Linux host.
+ *
+ * The .awb is only checked for readability, no graph is parsed. The layout is
+ * the Kanavi_passthrouh_test one: every input through ScalerN2 (masterGain +
+ * trimGain[c], dB or linear, smoothed), output c = input c, then Mute1
+ * (isMuted, smoothed). Geometry comes from the aweOS_init parameters, or
+ * AWE_STUB_LAYOUT=in,out,block,rate.
+ *
+ * AWE_STUB_COST adds synthetic CPU to every pump: "250" busy-waits 250 us,
+ * "40%" busy-waits 40% of the block period.
+ */
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<math.h>
+#include<time.h>
+#include<stdatomic.h>
+#define DEFINE_ERROR_STRINGS
+#include"AWECoreOS.h"
+#include"Kanavi_passthrouh_test_ControlInterface.h"
+
+#define STUB_MAX_TRIM 4     //ScalerN2 trimGain/targetGain/currentGain entries
+#define STUB_MODULE_WORDS 16
+
+/*One module member, handle and size as in the ControlInterface header*/
+typedef struct {
+    UINT32 handle;
+    UINT32 size;
+    UINT32 offset; //first word in Stub_module_t.word
+} Stub_member_t;
+
+enum { SC_PROFILE, SC_MASTER, SC_SMOOTH_TIME, SC_IS_DB, SC_SMOOTH_COEFF,
+       SC_TRIM, SC_TARGET = SC_TRIM + STUB_MAX_TRIM, SC_CURRENT = SC_TARGET + STUB_MAX_TRIM };
+enum { MU_PROFILE, MU_IS_MUTED, MU_SMOOTH_TIME, MU_CURRENT, MU_SMOOTH_COEFF, MU_GAIN };
+
+static const Stub_member_t scaler_members[] = {
+    { AWE_ScalerN2_profileTime_HANDLE,    AWE_ScalerN2_profileTime_SIZE,    SC_PROFILE },
+    { AWE_ScalerN2_masterGain_HANDLE,     AWE_ScalerN2_masterGain_SIZE,     SC_MASTER },
+    { AWE_ScalerN2_smoothingTime_HANDLE,  AWE_ScalerN2_smoothingTime_SIZE,  SC_SMOOTH_TIME },
+    { AWE_ScalerN2_isDB_HANDLE,           AWE_ScalerN2_isDB_SIZE,           SC_IS_DB },
+    { AWE_ScalerN2_smoothingCoeff_HANDLE, AWE_ScalerN2_smoothingCoeff_SIZE, SC_SMOOTH_COEFF },
+    { AWE_ScalerN2_trimGain_HANDLE,       AWE_ScalerN2_trimGain_SIZE,       SC_TRIM },
+    { AWE_ScalerN2_targetGain_HANDLE,     AWE_ScalerN2_targetGain_SIZE,     SC_TARGET },
+    { AWE_ScalerN2_currentGain_HANDLE,    AWE_ScalerN2_currentGain_SIZE,    SC_CURRENT },
+};
+
+static const Stub_member_t mute_members[] = {
+    { AWE_Mute1_profileTime_HANDLE,    AWE_Mute1_profileTime_SIZE,    MU_PROFILE },
+    { AWE_Mute1_isMuted_HANDLE,        AWE_Mute1_isMuted_SIZE,        MU_IS_MUTED },
+    { AWE_Mute1_smoothingTime_HANDLE,  AWE_Mute1_smoothingTime_SIZE,  MU_SMOOTH_TIME },
+    { AWE_Mute1_currentGain_HANDLE,    AWE_Mute1_currentGain_SIZE,    MU_CURRENT },
+    { AWE_Mute1_smoothingCoeff_HANDLE, AWE_Mute1_smoothingCoeff_SIZE, MU_SMOOTH_COEFF },
+    { AWE_Mute1_gain_HANDLE,           AWE_Mute1_gain_SIZE,           MU_GAIN },
+};
+
+/*
+ * Members are raw 32-bit words, so ctrlSet/GetValue from the control thread
+ * never tear against the pump. The pump keeps its ramp state locally and
+ * publishes it after each block.
+ */
+typedef struct {
+    UINT32 id;
+    const Stub_member_t *members;
+    UINT32 num_members;
+    _Atomic UINT32 word[STUB_MODULE_WORDS];
+    double profile; //filtered pump time, profileSpeed ticks
+} Stub_module_t;
+
+typedef struct {
+    AWEOSConfigParameters cfg;
+    int loaded;
+    UINT32 in_channels;
+    UINT32 out_channels;
+    UINT32 block_size;
+    FLOAT32 sample_rate;
+    float *in;  //[in_channels][block_size], full scale = 1.0
+    float *out; //[out_channels][block_size]
+    Stub_module_t scaler;
+    Stub_module_t mute;
+    float scaler_gain[STUB_MAX_TRIM];
+    float mute_gain;
+    UINT64 cost_ns;
+    UINT32 profiling;      //aweOS_setProfilingStatus: 0 off, 1 both, 2 modules, 3 top level
+    double layout_profile; //filtered pump time, profileSpeed ticks
+} Stub_instance_t;
+
+static inline float word_f(const Stub_module_t *m, UINT32 off) {
+    union { UINT32 u; float f; } v = { atomic_load_explicit(&m->word[off], memory_order_relaxed) };
+    return v.f;
+}
+
+static inline INT32 word_i(const Stub_module_t *m, UINT32 off) {
+    return (INT32)atomic_load_explicit(&m->word[off], memory_order_relaxed);
+}
+
+static inline void set_f(Stub_module_t *m, UINT32 off, float f) {
+    union { float f; UINT32 u; } v = { f };
+    atomic_store_explicit(&m->word[off], v.u, memory_order_relaxed);
+}
+
+static inline void set_i(Stub_module_t *m, UINT32 off, INT32 i) {
+    atomic_store_explicit(&m->word[off], (UINT32)i, memory_order_relaxed);
+}
+
+static UINT64 now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UINT64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*One-pole coefficient for a time constant in ms, 1 = no smoothing*/
+static float smoothing_coeff(float ms, FLOAT32 rate) {
+    return ms <= 0 ? 1.0f : 1.0f - expf(-1000.0f / (ms * rate));
+}
+
+/*Filtered like the real one (~1000 pumps to settle), seeded with the first pump*/
+static void profile_filter(const Stub_instance_t *st, double *profile, UINT64 ns) {
+    const double ticks = ns * 1e-9 * st->cfg.profileSpeed;
+    *profile = *profile == 0 ? ticks : *profile + (ticks - *profile) * 0.001;
+}
+
+static void module_profile(const Stub_instance_t *st, Stub_module_t *m, UINT64 ns) {
+    profile_filter(st, &m->profile, ns);
+    set_i(m, 0, (INT32)(m->profile * 256.0)); //24.8 fixed point
+}
+
+static void modules_reset(Stub_instance_t *st) {
+    memset(&st->scaler, 0, sizeof(st->scaler));
+    memset(&st->mute, 0, sizeof(st->mute));
+    st->scaler.id = AWE_ScalerN2_ID;
+    st->scaler.members = scaler_members;
+    st->scaler.num_members = sizeof(scaler_members) / sizeof(scaler_members[0]);
+    st->mute.id = AWE_Mute1_ID;
+    st->mute.members = mute_members;
+    st->mute.num_members = sizeof(mute_members) / sizeof(mute_members[0]);
+
+    set_f(&st->scaler, SC_MASTER, -20.0f);
+    set_f(&st->scaler, SC_SMOOTH_TIME, 10.0f);
+    set_i(&st->scaler, SC_IS_DB, 1);
+    for(int c = 0; c < STUB_MAX_TRIM; c++) {
+        set_f(&st->scaler, SC_TRIM + c, 0.0f);
+        st->scaler_gain[c] = powf(10.0f, -20.0f / 20.0f);
+        set_f(&st->scaler, SC_TARGET + c, st->scaler_gain[c]);
+        set_f(&st->scaler, SC_CURRENT + c, st->scaler_gain[c]);
+    }
+    set_i(&st->mute, MU_IS_MUTED, 0);
+    set_f(&st->mute, MU_SMOOTH_TIME, 10.0f);
+    set_f(&st->mute, MU_GAIN, 1.0f);
+    set_f(&st->mute, MU_CURRENT, 1.0f);
+    st->mute_gain = 1.0f;
+}
+
+static void scaler_process(Stub_instance_t *st) {
+    Stub_module_t *m = &st->scaler;
+    const float coeff = smoothing_coeff(word_f(m, SC_SMOOTH_TIME), st->sample_rate);
+    const float master = word_f(m, SC_MASTER);
+    const int is_db = word_i(m, SC_IS_DB);
+    set_f(m, SC_SMOOTH_COEFF, coeff);
+    for(UINT32 c = 0; c < st->in_channels; c++) {
+        const UINT32 t = c % STUB_MAX_TRIM;
+        const float trim = word_f(m, SC_TRIM + t);
+        const float target = is_db ? powf(10.0f, (master + trim) / 20.0f) : master * powf(10.0f, trim / 20.0f);
+        float gain = st->scaler_gain[t];
+        float *x = st->in + c * st->block_size;
+        for(UINT32 i = 0; i < st->block_size; i++) {
+            gain += coeff * (target - gain);
+            x[i] *= gain;
+        }
+        /*Channels sharing a trim entry start from the same ramp state*/
+        if(c + STUB_MAX_TRIM >= st->in_channels) {
+            st->scaler_gain[t] = gain;
+            set_f(m, SC_TARGET + t, target);
+            set_f(m, SC_CURRENT + t, gain);
+        }
+    }
+}
+
+static void mute_process(Stub_instance_t *st) {
+    Stub_module_t *m = &st->mute;
+    const float coeff = smoothing_coeff(word_f(m, MU_SMOOTH_TIME), st->sample_rate);
+    const float target = word_i(m, MU_IS_MUTED) ? 0.0f : 1.0f;
+    float gain = st->mute_gain;
+    set_f(m, MU_SMOOTH_COEFF, coeff);
+    set_f(m, MU_GAIN, target);
+    for(UINT32 c = 0; c < st->out_channels; c++) {
+        float *y = st->out + c * st->block_size;
+        gain = st->mute_gain;
+        for(UINT32 i = 0; i < st->block_size; i++) {
+            gain += coeff * (target - gain);
+            y[i] *= gain;
+        }
+    }
+    st->mute_gain = gain;
+    set_f(m, MU_CURRENT, gain);
+}
+
+static UINT64 parse_cost(const char *spec, UINT32 block, FLOAT32 rate) {
+    if(!spec || !*spec) {
+        return 0;
+    }
+    char *end;
+    double v = strtod(spec, &end);
+    if(v <= 0) {
+        return 0;
+    }
+    return *end == '%' ? (UINT64)(v / 100.0 * block * 1e9 / rate) : (UINT64)(v * 1000.0);
+}
+
+/*API*/
+INT32 aweOS_getParamDefaults(AWEOSConfigParameters *aweParams) {
+    if(!aweParams) {
+        return E_ARGUMENT_ERROR;
+    }
+    memset(aweParams, 0, sizeof(*aweParams));
+    aweParams->fastHeapASize = 5000000;
+    aweParams->fastHeapBSize = 5000000;
+    aweParams->slowHeapSize = 5000000;
+    aweParams->packetBufferSize = 264;
+    aweParams->userVersion = 1;
+    aweParams->coreSpeed = 1e9f;
+    aweParams->profileSpeed = 10e6f;
+    aweParams->pName = "aweOS";
+    aweParams->numThreads = 4;
+    aweParams->sampleRate = 48000.0f;
+    aweParams->fundamentalBlockSize = 32;
+    aweParams->inChannels = 2;
+    aweParams->outChannels = 2;
+    return E_SUCCESS;
+}
+
+INT32 aweOS_init(AWEOSInstance **pAWEOS, const AWEOSConfigParameters *aweParams,
+                 const void *pModuleDescriptorTable, UINT32 moduleDescriptorTableSize) {
+    (void)pModuleDescriptorTable;
+    (void)moduleDescriptorTableSize;
+    if(!pAWEOS || !aweParams || aweParams->inChannels == 0 || aweParams->outChannels == 0 ||
+       aweParams->fundamentalBlockSize == 0 || aweParams->sampleRate <= 0) {
+        return E_ARGUMENT_ERROR;
+    }
+    Stub_instance_t *st = calloc(1, sizeof(*st));
+    if(!st) {
+        return E_MALLOC_SIZE_TOO_BIG;
+    }
+    st->cfg = *aweParams;
+    st->profiling = 1;
+    *pAWEOS = st;
+    return E_SUCCESS;
+}
+
+INT32 aweOS_destroy(AWEOSInstance **pAWEOS) {
+    if(!pAWEOS || !*pAWEOS) {
+        return E_NOT_OBJECT_POINTER;
+    }
+    Stub_instance_t *st = *pAWEOS;
+    free(st->in);
+    free(st->out);
+    free(st);
+    *pAWEOS = NULL;
+    return E_SUCCESS;
+}
+
+INT32 aweOS_loadAWBFile(AWEOSInstance *pAWEOS, const char *binaryFile, UINT32 *pErrorOffset) {
+    Stub_instance_t *st = pAWEOS;
+    if(pErrorOffset) {
+        *pErrorOffset = 0;
+    }
+    if(!st) {
+        return E_NOT_OBJECT_POINTER;
+    }
+    FILE *fp = binaryFile ? fopen(binaryFile, "rb") : NULL;
+    if(!fp) {
+        return E_NOSUCHFILE;
+    }
+    fclose(fp);
+
+    UINT32 in = st->cfg.inChannels, out = st->cfg.outChannels, block = st->cfg.fundamentalBlockSize;
+    float rate = st->cfg.sampleRate;
+    const char *layout = getenv("AWE_STUB_LAYOUT");
+    if(layout && (sscanf(layout, "%u,%u,%u,%f", &in, &out, &block, &rate) != 4 ||
+                  in == 0 || out == 0 || block == 0 || rate <= 0)) {
+        return E_PARAMETER_ERROR;
+    }
+    free(st->in);
+    free(st->out);
+    st->in = calloc((size_t)in * block, sizeof(float));
+    st->out = calloc((size_t)out * block, sizeof(float));
+    if(!st->in || !st->out) {
+        return E_MALLOC_SIZE_TOO_BIG;
+    }
+    st->in_channels = in;
+    st->out_channels = out;
+    st->block_size = block;
+    st->sample_rate = rate;
+    st->cost_ns = parse_cost(getenv("AWE_STUB_COST"), block, rate);
+    modules_reset(st);
+    st->loaded = 1;
+    return E_SUCCESS;
+}
+
+INT32 aweOS_layoutGetChannelCount(const AWEOSInstance *pAWEOS, UINT32 *inCount, UINT32 *outCount) {
+    const Stub_instance_t *st = pAWEOS;
+    if(!st || !st->loaded) {
+        return E_NO_LAYOUTS;
+    }
+    *inCount = st->in_channels;
+    *outCount = st->out_channels;
+    return E_SUCCESS;
+}
+
+INT32 aweOS_layoutGetBlockSize(const AWEOSInstance *pAWEOS, UINT32 *blockSize) {
+    const Stub_instance_t *st = pAWEOS;
+    if(!st || !st->loaded) {
+        return E_NO_LAYOUTS;
+    }
+    *blockSize = st->block_size;
+    return E_SUCCESS;
+}
+
+INT32 aweOS_layoutGetSampleRate(const AWEOSInstance *pAWEOS, FLOAT32 *sampleRate) {
+    const Stub_instance_t *st = pAWEOS;
+    if(!st || !st->loaded) {
+        return E_NO_LAYOUTS;
+    }
+    *sampleRate = st->sample_rate;
+    return E_SUCCESS;
+}
+
+INT32 aweOS_layoutIsValid(const AWEOSInstance *pAWEOS) {
+    const Stub_instance_t *st = pAWEOS;
+    return st && st->loaded;
+}
+
+INT32 aweOS_audioIsStarted(const AWEOSInstance *pAWEOS) {
+    return aweOS_layoutIsValid(pAWEOS);
+}
+
+/*Channels the layout doesn't have are ignored on import and silent on export*/
+INT32 aweOS_audioImportSamples(AWEOSInstance *pAWEOS, void *inSamples, INT32 inStride, INT32 channel, SampleType inType) {
+    Stub_instance_t *st = pAWEOS;
+    if(!st || !st->loaded) {
+        return E_NO_LAYOUTS;
+    }
+    if(channel < 0 || inStride < 1) {
+        return E_ARGUMENT_ERROR;
+    }
+    if((UINT32)channel >= st->in_channels) {
+        return E_SUCCESS;
+    }
+    float *dst = st->in + channel * st->block_size;
+    const float scale32 = 1.0f / 2147483648.0f;
+    if(inType == Sample16bit) {
+        const INT16 *src = inSamples;
+        for(UINT32 i = 0; i < st->block_size; i++) {
+            dst[i] = src[(size_t)i * inStride] * (1.0f / 32768.0f);
+        }
+    } else {
+        const INT32 *src = inSamples;
+        for(UINT32 i = 0; i < st->block_size; i++) {
+            INT32 v = src[(size_t)i * inStride];
+            if(inType == Sample24bit_low) {
+                v = (INT32)((UINT32)v << 8);
+            } else if(inType == Sample24bit_high) {
+                v &= (INT32)0xFFFFFF00;
+            }
+            dst[i] = v * scale32;
+        }
+    }
+    return E_SUCCESS;
+}
+
+INT32 aweOS_audioExportSamples(AWEOSInstance *pAWEOS, void *outSamples, INT32 outStride, INT32 channel, SampleType outType) {
+    Stub_instance_t *st = pAWEOS;
+    if(!st || !st->loaded) {
+        return E_NO_LAYOUTS;
+    }
+    if(channel < 0 || outStride < 1) {
+        return E_ARGUMENT_ERROR;
+    }
+    const float *src = (UINT32)channel < st->out_channels ? st->out + channel * st->block_size : NULL;
+    for(UINT32 i = 0; i < st->block_size; i++) {
+        float x = src ? src[i] : 0.0f;
+        x = x > 1.0f ? 1.0f : x < -1.0f ? -1.0f : x;
+        /*Saturate in double, 1.0 * 2^31 doesn't fit*/
+        double s = (double)x * 2147483648.0;
+        INT32 v = s >= 2147483647.0 ? 0x7FFFFFFF : (INT32)s;
+        switch(outType) {
+        case Sample16bit:      ((INT16 *)outSamples)[(size_t)i * outStride] = (INT16)(v >> 16); break;
+        case Sample24bit_low:  ((INT32 *)outSamples)[(size_t)i * outStride] = v >> 8; break;
+        case Sample24bit_high: ((INT32 *)outSamples)[(size_t)i * outStride] = v & (INT32)0xFFFFFF00; break;
+        default:               ((INT32 *)outSamples)[(size_t)i * outStride] = v; break;
+        }
+    }
+    return E_SUCCESS;
+}
+
+INT32 aweOS_audioPumpAll(AWEOSInstance *pAWEOS) {
+    Stub_instance_t *st = pAWEOS;
+    if(!st || !st->loaded) {
+        return E_NO_LAYOUTS;
+    }
+    UINT64 t0 = now_ns();
+    scaler_process(st);
+    UINT64 t1 = now_ns();
+    for(UINT32 c = 0; c < st->out_channels; c++) {
+        float *y = st->out + c * st->block_size;
+        if(c < st->in_channels) {
+            memcpy(y, st->in + c * st->block_size, sizeof(float) * st->block_size);
+        } else {
+            memset(y, 0, sizeof(float) * st->block_size);
+        }
+    }
+    mute_process(st);
+    UINT64 t2 = now_ns();
+    if(st->cost_ns) {
+        /*Burn, don't sleep: this stands in for DSP work*/
+        const UINT64 until = t0 + st->cost_ns;
+        while(now_ns() < until) {
+        }
+    }
+    if(st->profiling == 1 || st->profiling == 2) {
+        module_profile(st, &st->scaler, t1 - t0);
+        module_profile(st, &st->mute, t2 - t1);
+    }
+    if(st->profiling == 1 || st->profiling == 3) {
+        profile_filter(st, &st->layout_profile, now_ns() - t0);
+    }
+    return E_SUCCESS;
+}
+
+INT32 aweOS_setProfilingStatus(AWEOSInstance *pAWEOS, UINT32 status) {
+    Stub_instance_t *st = pAWEOS;
+    if(!st) {
+        return E_NOT_CREATED;
+    }
+    if(status > 3) {
+        return E_PARAMETER_ERROR;
+    }
+    st->profiling = status;
+    return E_SUCCESS;
+}
+
+/*24.8, profileSpeed ticks; the synthetic AWE_STUB_COST counts as layout time*/
+INT32 aweOS_getAverageLayoutCycles(AWEOSInstance *pAWEOS, UINT32 idx, UINT32 *averageCycles) {
+    Stub_instance_t *st = pAWEOS;
+    if(!st) {
+        return E_NOT_CREATED;
+    }
+    if(!st->loaded) {
+        return E_NO_LAYOUTS;
+    }
+    if(idx != 0 || !averageCycles) {
+        return E_PARAMETER_ERROR;
+    }
+    *averageCycles = (UINT32)(st->layout_profile * 256.0);
+    return E_SUCCESS;
+}
+
+static Stub_module_t *find_member(const Stub_instance_t *st, UINT32 handle, const Stub_member_t **member) {
+    Stub_module_t *mods[] = { (Stub_module_t *)&st->scaler, (Stub_module_t *)&st->mute };
+    for(size_t m = 0; m < sizeof(mods) / sizeof(mods[0]); m++) {
+        for(UINT32 i = 0; i < mods[m]->num_members; i++) {
+            if(mods[m]->members[i].handle == handle) {
+                *member = &mods[m]->members[i];
+                return mods[m];
+            }
+        }
+    }
+    return NULL;
+}
+
+static INT32 ctrl_access(const AWEOSInstance *pAWEOS, UINT32 handle, void *value, INT32 arrayOffset,
+                         UINT32 length, int set) {
+    const Stub_instance_t *st = pAWEOS;
+    const Stub_member_t *member;
+    if(!st || !st->loaded) {
+        return E_NO_LAYOUTS;
+    }
+    Stub_module_t *mod = find_member(st, handle, &member);
+    if(!mod) {
+        return E_OBJECT_ID_NOT_FOUND;
+    }
+    if(!value || arrayOffset < 0 || length == 0 || (UINT32)arrayOffset + length > member->size) {
+        return E_BAD_MEMBER_INDEX;
+    }
+    UINT32 *words = value;
+    for(UINT32 i = 0; i < length; i++) {
+        _Atomic UINT32 *w = &mod->word[member->offset + arrayOffset + i];
+        if(set) {
+            atomic_store_explicit(w, words[i], memory_order_relaxed);
+        } else {
+            words[i] = atomic_load_explicit(w, memory_order_relaxed);
+        }
+    }
+    return E_SUCCESS;
+}
+
+INT32 aweOS_ctrlSetValue(const AWEOSInstance *pAWEOS, UINT32 handle, void *value, INT32 arrayOffset, UINT32 length) {
+    return ctrl_access(pAWEOS, handle, value, arrayOffset, length, 1);
+}
+
+INT32 aweOS_ctrlGetValue(const AWEOSInstance *pAWEOS, UINT32 handle, void *value, INT32 arrayOffset, UINT32 length) {
+    return ctrl_access(pAWEOS, handle, value, arrayOffset, length, 0);
+}
+
+/*Stub modules have no set/get functions, the mask has nothing to skip*/
+INT32 aweOS_ctrlSetValueMask(const AWEOSInstance *pAWEOS, UINT32 handle, void *value, INT32 arrayOffset,
+                             UINT32 length, UINT32 mask) {
+    (void)mask;
+    return ctrl_access(pAWEOS, handle, value, arrayOffset, length, 1);
+}
+
+INT32 aweOS_ctrlGetValueMask(const AWEOSInstance *pAWEOS, UINT32 handle, void *value, INT32 arrayOffset,
+                             UINT32 length, UINT32 mask) {
+    (void)mask;
+    return ctrl_access(pAWEOS, handle, value, arrayOffset, length, 0);
+}
+
+/*No internal threads: pumps run on the caller, no tuning socket*/
+UINT32 aweOS_getThreadPIDs(AWEOSInstance *pAWEOS, AWEOSThreadPIDs_t *threadPIDs) {
+    if(!pAWEOS || !threadPIDs) {
+        return (UINT32)E_NOT_CREATED;
+    }
+    memset(threadPIDs, 0, sizeof(*threadPIDs));
+    return E_SUCCESS;
+}
+
+INT32 aweOS_tuningSocketOpen(AWEOSInstance **pAWEOS, INT32 portNo, UINT32 numInstances) {
+    (void)pAWEOS;
+    (void)portNo;
+    (void)numInstances;
+    return E_SYSCALL;
+}
+
+void aweOS_tuningSocketClose(AWEOSInstance *pAWEOS) {
+    (void)pAWEOS;
+}
+
+const char *aweOS_errorToString(INT32 errorCode) {
+    const INT32 count = (INT32)(sizeof(s_error_strings) / sizeof(s_error_strings[0]));
+    if(errorCode > 0 || -errorCode >= count) {
+        return "unknown error";
+    }
+    return s_error_strings[-errorCode];
+}
+
+void aweOS_getVersion(AWEOSVersionInfo_t *versionInfo) {
+    memset(versionInfo, 0, sizeof(*versionInfo));
+    versionInfo->majorVer = 'A';
+    versionInfo->textVer = "AWECoreOS native stand-in";
+}
+
+/*WAV: 44 byte PCM header, sizes patched on close*/
+static void put_le(unsigned char *p, UINT32 v, int bytes) {
+    for(int i = 0; i < bytes; i++) {
+        p[i] = (unsigned char)(v >> (8 * i));
+    }
+}
+
+static int write_wav_header(FILE *fp, UINT32 rate, UINT32 channels, UINT32 sampleSize, UINT32 dataBytes) {
+    unsigned char h[44];
+    memcpy(h, "RIFF", 4);
+    put_le(h + 4, 36 + dataBytes, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put_le(h + 16, 16, 4);
+    put_le(h + 20, 1, 2);
+    put_le(h + 22, channels, 2);
+    put_le(h + 24, rate, 4);
+    put_le(h + 28, rate * channels * sampleSize, 4);
+    put_le(h + 32, channels * sampleSize, 2);
+    put_le(h + 34, sampleSize * 8, 2);
+    memcpy(h + 36, "data", 4);
+    put_le(h + 40, dataBytes, 4);
+    return fwrite(h, sizeof(h), 1, fp) == 1 ? 0 : -1;
+}
+
+INT32 aweOS_wavFileCreate(const char *file, FLOAT32 sampleRate, UINT32 numChannels, UINT32 sampleSize, FILE **fp) {
+    if(!file || !fp || numChannels == 0 || (sampleSize != 2 && sampleSize != 3 && sampleSize != 4)) {
+        return E_ARGUMENT_ERROR;
+    }
+    *fp = fopen(file, "wb+");
+    if(!*fp) {
+        return E_BAD_FILENAME;
+    }
+    if(write_wav_header(*fp, (UINT32)sampleRate, numChannels, sampleSize, 0) != 0) {
+        fclose(*fp);
+        *fp = NULL;
+        return E_BAD_FILENAME;
+    }
+    return E_SUCCESS;
+}
+
+INT32 aweOS_wavFileWrite(FILE *fp, void *samples, UINT32 numSamples, UINT32 sampleSize) {
+    if(!fp || !samples) {
+        return E_ARGUMENT_ERROR;
+    }
+    return (INT32)fwrite(samples, sampleSize, numSamples, fp);
+}
+
+INT32 aweOS_wavFileClose(FILE *fp) {
+    if(!fp) {
+        return E_ARGUMENT_ERROR;
+    }
+    unsigned char h[44];
+    long end = ftell(fp);
+    if(end >= 44 && fseek(fp, 0, SEEK_SET) == 0 && fread(h, sizeof(h), 1, fp) == 1) {
+        put_le(h + 4, (UINT32)end - 8, 4);
+        put_le(h + 40, (UINT32)end - 44, 4);
+        fseek(fp, 0, SEEK_SET);
+        fwrite(h, sizeof(h), 1, fp);
+    }
+    return fclose(fp) == 0 ? E_SUCCESS : E_BAD_FILENAME;
+}
@@ -0,0 +1,83 @@
+# Control registry from an AudioWeaver tuning symbol file (*_ControlInterface.h).
+# Every module block looks like
+#   #define AWE_<module>_classID 0x...
+#   #define AWE_<module>_ID 30001
+#   // <type> <param>[<size>] - description
+#   // Range: <min> to <max>            (optional)
+#   #define AWE_<module>_<param>_HANDLE / _MASK / _SIZE
+# and becomes one Control_object_t per parameter. A module's first ranged
+# parameter is its primary one, what "set <object ID> value" writes.
+#
+# awk -f tools/control_registry.awk inc/Graph_ControlInterface.h > control_registry_table.c
+
+BEGIN {
+    n = 0
+    reset_param()
+}
+
+function reset_param() {
+    type = "int"
+    has_range = 0
+    lo = 0
+    hi = 0
+}
+
+function ctype(t) {
+    if (t == "float") return "CONTROL_TYPE_FLOAT"
+    if (t == "uint") return "CONTROL_TYPE_UINT"
+    return "CONTROL_TYPE_INT"
+}
+
+/^#define AWE_[A-Za-z0-9_]+_classID / {
+    class_id = $3
+    next
+}
+
+/^#define AWE_[A-Za-z0-9_]+_ID / {
+    module = $2
+    sub(/^AWE_/, "", module)
+    sub(/_ID$/, "", module)
+    object_id = $3
+    have_primary = 0
+    next
+}
+
+/^\/\/ (float|int|uint|fract32) / {
+    reset_param()
+    type = $2
+    next
+}
+
+/^\/\/ Range: / {
+    lo = $3
+    hi = $5
+    has_range = 1
+    next
+}
+
+/^#define AWE_[A-Za-z0-9_]+_HANDLE / { handle = $3; next }
+/^#define AWE_[A-Za-z0-9_]+_MASK / { mask = $3; next }
+
+/^#define AWE_[A-Za-z0-9_]+_SIZE / {
+    param = $2
+    sub("^AWE_" module "_", "", param)
+    sub(/_SIZE$/, "", param)
+    primary = has_range && !have_primary
+    if (primary) have_primary = 1
+    line[n++] = sprintf("    { \"%s.%s\", \"%s\", %s, %s, %s, %s, %s, %s, %d, %s, %s, %d },",
+                        module, param, module, object_id, class_id, handle, mask, $3,
+                        ctype(type), has_range, lo, hi, primary)
+    reset_param()
+    next
+}
+
+END {
+    print "/*Generated by tools/control_registry.awk from " FILENAME ", do not edit*/"
+    print "#include\"control_registry.h\""
+    print ""
+    print "const Control_object_t control_objects[] = {"
+    for (i = 0; i < n; i++) print line[i]
+    print "    { NULL }"
+    print "};"
+    print "const UINT32 control_object_count = " n ";"
+}